@@ -0,0 +1,1186 @@
+/*
+ * Machine Description Interface Operations C API
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/**
+ *
+ * @file mdi_operations.h
+ *
+ * @brief Machine Description Interface Operations, C abstract interface.
+ *
+ * The Operations interface provides access to executable architecture
+ * Operators as defined in the MDI interface.
+ *
+ * An executable Operator is abstracvted into an Operation instance from
+ * which a Encoders, Disassemblers, Executions can work on.
+ * Operations are created from Decoders and Assemblers.
+ *
+ */
+
+#ifndef _MDI_OPERATIONS_H_INCLUDED
+#define _MDI_OPERATIONS_H_INCLUDED
+
+#include <MDI/mdi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup MDI_Operation Operation object
+ *
+ * An abstract object for Operation, an executable
+ * Operator instance.
+ */
+/**@{*/
+/**
+ * @brief Operation object abstraction
+ *
+ * An Operation is an executable instance of a MDI
+ * Operator.
+ * Decoders create new Operations from binary buffers.
+ * Assemblers create new Operations from assembly buffers.
+ * Disassemblers output assembly forms of Operations,
+ * Executions execute Operations,
+ * Encoders output encoded Operations into binary buffers.
+ */
+typedef MDI_object_t MDI_Operation_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_DecodeInfo Decode location information
+ *
+ * Decode location information for decoded Operations.
+ */
+/**@{*/
+
+/**
+ * @brief DecodeInfo object abstraction
+ *
+ * When an Operation was created by a Decoder for instance,
+ * the Decoder may attach a DecodeInfo object to the Operation
+ * such that other clients may use this information.
+ * For instance a Disassembler may output the origin address of
+ * the Operation when the DecodeInfo object is available.
+ */
+typedef MDI_object_t MDI_DecodeInfo_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_OperationPool Operation pool object
+ *
+ * An abstract object for grouped allocation of Operations.
+ */
+/**@{*/
+/**
+ * @brief OperationPool object abstraction
+ *
+ * An OperationPool is an arena from which Operations can be
+ * allocated. All Operations allocated from a pool are released
+ * at once when the pool is reset or destroyed.
+ */
+typedef MDI_object_t MDI_OperationPool_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_Decoder Decoder object
+ *
+ * An abstract object for decoding buffers into Operations.
+ */
+/**@{*/
+/**
+ * @brief Decoder object abstraction
+ *
+ * All decoding operation, i.e. construction of Operations
+ * from encoded execution buffers are handled through this
+ * object.
+ */
+typedef MDI_object_t MDI_Decoder_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_DecodeCache Decode cache object
+ *
+ * An abstract object for caching decoded Operations.
+ */
+/**@{*/
+/**
+ * @brief DecodeCache object abstraction
+ *
+ * A DecodeCache holds Operations decoded by a Decoder, keyed
+ * by their decode buffer and offset, such that repeated decoding
+ * at the same location, for instance when executing a loop, does not
+ * pay the decoding cost again.
+ */
+typedef MDI_object_t MDI_DecodeCache_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_Program Program object
+ *
+ * An abstract object holding decoded code as arrays.
+ */
+/**@{*/
+/**
+ * @brief Program object abstraction
+ *
+ * A Program holds the Operations decoded successively from a
+ * buffer as parallel arrays indexed by Operation: Operator indexes,
+ * buffer offsets, encoded sizes and operands, such that analyses
+ * and translations stream through decoded code without an Operation
+ * object per decoded Operation.
+ */
+typedef MDI_object_t MDI_Program_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_Disassembler Disassembler object
+ *
+ * An abstract object for disassembling Operations into assembly buffers.
+ */
+/**@{*/
+/**
+ * @brief Disassembler object abstraction
+ *
+ * All assembling operations, i.e. construction of assembly buffers
+ * from Operation objects are handled through this object.
+ */
+typedef MDI_object_t MDI_Disassembler_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_Execution Execution context object
+ *
+ * An abstract object for executing Operations.
+ */
+/**@{*/
+/**
+ * @brief Execution object abstraction
+ *
+ * All operations executions, i.e. state change on a Processor and
+ * associated peripherals by the execution of an Operation are
+ * handled through this object.
+ */
+typedef MDI_object_t MDI_Execution_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_ThreadedCode Threaded code object
+ *
+ * An abstract object for executing translated Operations.
+ */
+/**@{*/
+/**
+ * @brief ThreadedCode object abstraction
+ *
+ * A ThreadedCode is a translation of a range of decoded Operations
+ * for a given Execution context, such that the Execution can run
+ * them without per Operation client calls.
+ */
+typedef MDI_object_t MDI_ThreadedCode_t;
+/**@}*/
+
+/**
+ * @addtogroup MDI_Operation
+ */
+/**@{*/
+
+/**
+ * @brief Create a new Operation
+ *
+ * Create a new operation for the given opcode and operands list.
+ *
+ * @param self_ref A reference to the Operation object to construct.
+ * @param operator The Operation MDI Operator.
+ * @param opcount The Operation number of operands.
+ * @param operands The pointer to the Abstract Operands buffer.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_init(MDI_Operation_t *self_ref, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params);
+
+/**
+ * @brief Operation storage size
+ *
+ * Get the storage size in bytes necessary for constructing an
+ * Operation with the given number of operands in a client
+ * provided storage with MDI_Operation_init_storage().
+ * The storage size includes the operands and an inline DecodeInfo.
+ *
+ * @param opcount The Operation number of operands.
+ * @return The storage size in bytes.
+ */
+MDI_INTERFACE MDI_size_t MDI_Operation_storage_size(MDI_size_t opcount);
+
+/**
+ * @brief Operation storage alignment
+ *
+ * Get the alignment in bytes required for a client provided
+ * Operation storage.
+ * Note that storages returned by malloc() are always suitably aligned.
+ *
+ * @return The storage alignment in bytes.
+ */
+MDI_INTERFACE MDI_size_t MDI_Operation_storage_align(void);
+
+/**
+ * @brief Create a new Operation into a client storage
+ *
+ * Same as MDI_Operation_init(), though the Operation, its operands
+ * and its inline DecodeInfo are constructed into the given storage,
+ * without any allocation.
+ * The storage must be at least MDI_Operation_storage_size() bytes,
+ * aligned on MDI_Operation_storage_align() and must remain valid
+ * until the Operation is destroyed with MDI_Operation_fini(), which
+ * does not release the storage.
+ *
+ * @param self_ref A reference to the Operation object to construct.
+ * @param storage The storage for the Operation.
+ * @param storage_size The storage size in bytes.
+ * @param operator The Operation MDI Operator.
+ * @param opcount The Operation number of operands.
+ * @param operands The pointer to the Abstract Operands buffer.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_init_storage(MDI_Operation_t *self_ref, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params);
+
+/**
+ * @brief Create a new Operation from an OperationPool
+ *
+ * Same as MDI_Operation_init(), though the Operation storage is
+ * allocated from the given pool.
+ * Calling MDI_Operation_fini() on such an Operation is valid but does
+ * not release its storage, which is released when the pool is reset
+ * or destroyed.
+ *
+ * @param self_ref A reference to the Operation object to construct.
+ * @param pool The OperationPool to allocate from.
+ * @param operator The Operation MDI Operator.
+ * @param opcount The Operation number of operands.
+ * @param operands The pointer to the Abstract Operands buffer.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_init_pool(MDI_Operation_t *self_ref, MDI_OperationPool_t pool, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params);
+
+/**
+ * @brief Destroy an Operation instance
+ *
+ * Destructor for an Operation instance.
+ *
+ * @param self_ref A reference to a valid Operation instance.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_fini(MDI_Operation_t *self_ref);
+
+/**
+ * @brief MDI Operator for an Operation
+ *
+ * Get the MDI Operator associated to the Operation instance.
+ *
+ * @param self The Operation.
+ * @return The MDI Operator.
+ */
+MDI_INTERFACE MDI_Operator_t MDI_Operation_operator(MDI_Operation_t self);
+
+/**
+ * @brief Operands count for an Operation
+ *
+ * Get the actual operands count for an operation.
+ *
+ * @param self The Operation.
+ * @return The number of operands.
+ */
+MDI_INTERFACE MDI_size_t MDI_Operation_opcount(MDI_Operation_t self);
+
+/**
+ * @brief Abstract pointer to operands of an operation.
+ *
+ * Get the pointer to the Operation's operands. Implementation defined.
+ *
+ * @param self The Operation.
+ * @return The operands pointer.
+ */
+MDI_INTERFACE MDI_ptr_t MDI_Operation_operands(MDI_Operation_t self);
+
+/**
+ * @brief Abstract pointer to decode information
+ *
+ * Abstract DecodeInfo object for the Operation is avazilable.
+ *
+ * @param self The Operation.
+ * @return The DecodeInfo object or NULL.
+ */
+MDI_INTERFACE MDI_DecodeInfo_t MDI_Operation_decode_info(MDI_Operation_t self);
+
+/**
+ * @brief Set abstract decode information
+ *
+ * Set the DecodeInfo object for the Operation.
+ *
+ * @param self The Operation.
+ * @param decode_info The DecodeInfo object.
+ */
+MDI_INTERFACE void MDI_Operation_set_decode_info(MDI_Operation_t self, MDI_DecodeInfo_t decode_info);
+
+/**
+ * @brief Initialize inline decode information
+ *
+ * Initialize the DecodeInfo object held inline by the Operation
+ * and set it as the Operation DecodeInfo object, without any
+ * allocation.
+ * The inline DecodeInfo lives as long as the Operation, calling
+ * MDI_DecodeInfo_fini() on it is valid and has no effect.
+ *
+ * @param self The Operation.
+ * @param buffer The decode buffer address.
+ * @param offset The offset in the decode buffer.
+ * @param size The size of the encoded Operation at the decoded offset.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_init_decode_info(MDI_Operation_t self, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size, MDI_object_t params);
+/**@}*/
+
+/**
+ * @addtogroup MDI_DecodeInfo
+ */
+/**@{*/
+
+/**
+ * @brief Create a new DecodeInfo
+ *
+ * Create a new DecodeInfo instance.
+ *
+ * @param self_ref A reference to the DecodeInfo object to construct.
+ * @param buffer The decode buffer address.
+ * @param offset The offset in the decode buffer.
+ * @param size The size of the encoded Operation at the decoded offset.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_DecodeInfo_init(MDI_DecodeInfo_t *self_ref, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size, MDI_object_t params);
+
+/**
+ * @brief Destroy a DecodeInfo instance
+ *
+ * Destructor for an DecodeInfo instance.
+ *
+ * @param self_ref A reference to a valid DecodeInfo instance.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_DecodeInfo_fini(MDI_DecodeInfo_t *self_ref);
+
+/**
+ * @brief Decode buffer
+ *
+ * Get the origin decode buffer address for the DecodeInfo.
+ * Note that this buffer address may not be a valid address to
+ * dereference, it may though be used as an information in 
+ * Disassemblers outputs for instance.
+ * 
+ * @param self The DecodeInfo.
+ * @return The origin decoding buffer.
+ */
+MDI_INTERFACE MDI_ptr_t MDI_DecodeInfo_buffer(MDI_DecodeInfo_t self);
+
+/**
+ * @brief Decode offset
+ *
+ * Get the origin byte offset into the origin decode buffer.
+ *
+ * @param self The DecodeInfo.
+ * @return The origin decoding offset.
+ */
+MDI_INTERFACE MDI_size_t MDI_DecodeInfo_offset(MDI_DecodeInfo_t self);
+
+/**
+ * @brief Decode size
+ *
+ * Get the encoded size for the decoded Operation.
+ *
+ * @param self The DecodeInfo.
+ * @return The encoded size.
+ */
+MDI_INTERFACE MDI_size_t MDI_DecodeInfo_size(MDI_DecodeInfo_t self);
+/**@}*/
+
+/**
+ * @addtogroup MDI_OperationPool
+ */
+/**@{*/
+
+/**
+ * @brief Create a new OperationPool
+ *
+ * Create a new empty pool. Storage is reserved by chunks of
+ * chunk_size bytes, larger chunks are reserved for larger
+ * allocations.
+ *
+ * @param self_ref A reference to the OperationPool object to construct.
+ * @param chunk_size The chunk size in bytes, or 0 for a default size.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_OperationPool_init(MDI_OperationPool_t *self_ref, MDI_size_t chunk_size, MDI_object_t params);
+
+/**
+ * @brief Destroy an OperationPool
+ *
+ * Release all the pool storage, including all the Operations
+ * allocated from it, which must not be used anymore.
+ *
+ * @param self_ref A reference to a valid OperationPool object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_OperationPool_fini(MDI_OperationPool_t *self_ref);
+
+/**
+ * @brief Reset an OperationPool
+ *
+ * Drop at once all the Operations allocated from the pool, which
+ * must not be used anymore. The pool storage is kept for
+ * subsequent allocations.
+ *
+ * @param self An OperationPool.
+ */
+MDI_INTERFACE void MDI_OperationPool_reset(MDI_OperationPool_t self);
+
+/**
+ * @brief Allocate from an OperationPool
+ *
+ * Allocate size bytes aligned on align bytes from the pool.
+ * This is a bump allocation which can be used for instance to get
+ * storages for MDI_Operation_init_storage().
+ *
+ * @param self An OperationPool.
+ * @param size The size in bytes.
+ * @param align The alignment in bytes, a power of 2.
+ * @return The allocated storage or NULL.
+ */
+MDI_INTERFACE MDI_ptr_mut_t MDI_OperationPool_alloc(MDI_OperationPool_t self, MDI_size_t size, MDI_size_t align);
+/**@}*/
+
+/**
+ * @addtogroup MDI_Decoder
+ */
+/**@{*/
+
+/**
+ * @brief Create a new Decoder
+ *
+ * Create a new decoder instance for the given machine description
+ * and the processor.
+ *
+ * @param self_ref A reference to the Decoder object to construct.
+ * @param mdi A MDI machine description instance
+ * @param processor The Processor to decode for.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Decoder_init(MDI_Decoder_t *self_ref, MDI_interface_t mdi, MDI_Processor_t processor, MDI_object_t params);
+
+/**
+ * @brief Destroy a Decoder instance
+ *
+ * Destructor for a Decoder instance.
+ *
+ * @param self_ref A reference to a valid Decoder instance.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Decoder_fini(MDI_Decoder_t *self_ref);
+
+/**
+ * @brief Set the Decoder OperationPool
+ *
+ * Set the pool from which MDI_Decoder_decode() and
+ * MDI_Decoder_decode_batch() allocate new Operations.
+ * By default or when pool is @c NULL, Operations are allocated
+ * as for MDI_Operation_init().
+ *
+ * @param self A Decoder.
+ * @param pool The OperationPool or @c NULL.
+ */
+MDI_INTERFACE void MDI_Decoder_set_pool(MDI_Decoder_t self, MDI_OperationPool_t pool);
+
+/**
+ * @brief Set the Decoder origin
+ *
+ * Set the stream offset of the decoded buffers, added to the
+ * offsets recorded in the DecodeInfo of the decoded Operations.
+ * This allows a client decoding a stream by chunks to get Operation
+ * offsets relative to the start of the stream. The DecodeInfo buffer
+ * is moved back by the origin, i.e. it is the virtual stream start,
+ * such that buffer + offset is still the Operation address.
+ * The default origin is 0.
+ *
+ * @param self A Decoder.
+ * @param origin The stream offset of the decoded buffers start.
+ */
+MDI_INTERFACE void MDI_Decoder_set_origin(MDI_Decoder_t self, MDI_size_t origin);
+
+/**
+ * @brief Decode a buffer into an Operation
+ *
+ * Given the buffer and buffer_size to an encoded stream, decode
+ * current_ptr into an Operation and update current_ptr.
+ *
+ * The current_ptr reference must point to a position inside the
+ * given buffer. It will not be updated if the decode point is an invalid
+ * Opcode. Otherwise if a valid Opcode if found, the decoder will
+ * construct the associated Operation and update the current_ptr reference
+ * to the next decoding point.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param current_ptr The reference to the current decoding pointer.
+ * @return A new Operation instance or NULL on invalid Opcode..
+ */
+MDI_INTERFACE MDI_Operation_t MDI_Decoder_decode(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr);
+
+/**
+ * @brief Decoded Operations storage size
+ *
+ * Get the storage size in bytes sufficient for any Operation
+ * decoded by this Decoder with MDI_Decoder_decode_storage().
+ *
+ * @param self A Decoder.
+ * @return The storage size in bytes.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_storage_size(MDI_Decoder_t self);
+
+/**
+ * @brief Decode a buffer into an Operation in a client storage
+ *
+ * Same as MDI_Decoder_decode(), though the Operation and its
+ * DecodeInfo are constructed into the given storage as for
+ * MDI_Operation_init_storage(), without any allocation.
+ * The storage must be at least MDI_Decoder_storage_size() bytes.
+ *
+ * @param self A Decoder.
+ * @param storage The storage for the Operation.
+ * @param storage_size The storage size in bytes.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param current_ptr The reference to the current decoding pointer.
+ * @return The Operation constructed in storage or NULL on invalid Opcode.
+ */
+MDI_INTERFACE MDI_Operation_t MDI_Decoder_decode_storage(MDI_Decoder_t self, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr);
+
+/**
+ * @name Decoder batch stop reasons
+ *
+ * Reasons for MDI_Decoder_decode_batch() to return.
+ * @{
+ */
+#define MDI_DECODE_STOP_COUNT 1    /**< The Operations array is full. */
+#define MDI_DECODE_STOP_END 2      /**< The end of the buffer was reached. */
+#define MDI_DECODE_STOP_PARTIAL 3  /**< The buffer ends before the end of an encoded Operation. */
+#define MDI_DECODE_STOP_INVALID 4  /**< An invalid Opcode was found. */
+#define MDI_DECODE_STOP_ERROR 5    /**< An Operation could not be constructed. */
+/**@}*/
+
+/**
+ * @brief Decode a buffer into an array of Operations
+ *
+ * Given the buffer and buffer_size to an encoded stream, decode
+ * successive Operations from current_ptr into the caller provided
+ * operations array, up to max_count Operations.
+ *
+ * This is equivalent to successive calls to MDI_Decoder_decode(),
+ * though the current_ptr reference may point to the buffer limit
+ * (buffer + buffer_size) and on return current_ptr is updated to the
+ * decoding point following the last decoded Operation.
+ * Hence the number of consumed bytes is the difference between the
+ * returned and the initial current_ptr values.
+ *
+ * The reason for stopping is returned in stop_ref as one of the
+ * MDI_DECODE_STOP_* values. In particular MDI_DECODE_STOP_PARTIAL
+ * allows a client decoding a stream by chunks to continue decoding
+ * from current_ptr once more bytes are available.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param current_ptr The reference to the current decoding pointer.
+ * @param operations The array receiving new Operation instances.
+ * @param max_count The number of Operations available in the array.
+ * @param stop_ref A reference receiving the stop reason, may be @c NULL.
+ * @return The number of Operations decoded into the array.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_decode_batch(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr, MDI_Operation_t *operations, MDI_size_t max_count, MDI_res_t *stop_ref);
+
+/**
+ * @brief Split a buffer at Operation boundaries
+ *
+ * Split the encoded buffer into at most max_chunks ranges of about
+ * the same size, each starting at an Operation boundary, without
+ * decoding. Decoding each range independently, for instance on
+ * separate threads with one Decoder each, gives the same Operations
+ * as decoding the whole buffer.
+ *
+ * The bounds array receives the returned count plus one offsets,
+ * range i being [bounds[i], bounds[i+1]), with bounds[0] being 0 and
+ * bounds[count] being buffer_size.
+ * Less ranges may be returned for small buffers.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param max_chunks The maximum number of ranges, at least 1.
+ * @param bounds The array receiving max_chunks + 1 offsets at most.
+ * @return The number of ranges.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_split(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_size_t max_chunks, MDI_size_t *bounds);
+
+/**
+ * @brief Index the Operation starts of a buffer
+ *
+ * Scan the encoded buffer for the offsets at which successive
+ * decodes from the buffer start would start, without decoding.
+ * The index allows random access decode, splitting, or Program
+ * Counter to Operation lookups by binary search.
+ * The last offset may start a partial or invalid Operation, which
+ * is only detected when decoding.
+ *
+ * The number of Operation starts is returned, though only the
+ * first max_count offsets are stored, buffer_size offsets being
+ * always enough.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer, at most 4GB.
+ * @param offsets The array receiving the offsets, may be @c NULL if max_count is 0.
+ * @param max_count The size of the offsets array.
+ * @return The number of Operation starts in the buffer.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_index(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, uint32_t *offsets, MDI_size_t max_count);
+
+/**
+ * @brief Attach a predecoded file for a buffer
+ *
+ * A predecoded file holds the Operations decoded successively from
+ * the buffer start in an implementation defined flat layout which is
+ * mapped in memory. It is keyed by a hash of the buffer content and
+ * the MDI revision.
+ * If fname is a predecoded file for the buffer it is mapped,
+ * otherwise the buffer is decoded and fname is written first.
+ * While attached, decodes from the buffer at the predecoded
+ * Operation starts construct the Operations without parsing the
+ * encoding, other decodes are unchanged.
+ * The buffer content must not change while attached.
+ * A @c NULL buffer detaches the current predecoded file.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer or @c NULL.
+ * @param buffer_size The size of the encoded buffer, at most 4GB.
+ * @param fname The predecoded file name.
+ * @return 0 on success, failure otherwise in which case the Decoder parses all decodes.
+ */
+MDI_INTERFACE MDI_res_t MDI_Decoder_predecode(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_str_t fname);
+/**@}*/
+
+/**
+ * @addtogroup MDI_DecodeCache
+ */
+/**@{*/
+
+/**
+ * @brief Create a new DecodeCache
+ *
+ * Create a new decode cache of the given number of entries for the
+ * given Decoder. The Decoder must remain valid until the cache
+ * is destroyed.
+ *
+ * @param self_ref A reference to the DecodeCache object to construct.
+ * @param decoder The Decoder used on cache misses.
+ * @param entries The number of cached Operations, or 0 for a default size.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_DecodeCache_init(MDI_DecodeCache_t *self_ref, MDI_Decoder_t decoder, MDI_size_t entries, MDI_object_t params);
+
+/**
+ * @brief Destroy a DecodeCache
+ *
+ * Destruct a valid DecodeCache object and all its cached Operations.
+ *
+ * @param self_ref A reference to a valid DecodeCache object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_DecodeCache_fini(MDI_DecodeCache_t *self_ref);
+
+/**
+ * @brief Decode a buffer into a cached Operation
+ *
+ * Same as MDI_Decoder_decode(), though the Operation is returned from
+ * the cache when the same buffer location was already decoded.
+ *
+ * The returned Operation is owned by the cache, the client must not
+ * destroy it. It remains valid until the next call to
+ * MDI_DecodeCache_decode(), MDI_DecodeCache_invalidate() or
+ * MDI_DecodeCache_fini() on this cache.
+ *
+ * @param self A DecodeCache.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param current_ptr The reference to the current decoding pointer.
+ * @return The cached Operation instance or NULL on invalid Opcode.
+ */
+MDI_INTERFACE MDI_Operation_t MDI_DecodeCache_decode(MDI_DecodeCache_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr);
+
+/**
+ * @brief Invalidate a code range
+ *
+ * Drop all cached Operations for the given buffer whose encoding
+ * overlaps the [offset, offset + size) range.
+ * This must be called when the encoded buffer is modified.
+ *
+ * @param self A DecodeCache.
+ * @param buffer An encoded buffer pointer.
+ * @param offset The range start offset in the encoded buffer.
+ * @param size The range size.
+ */
+MDI_INTERFACE void MDI_DecodeCache_invalidate(MDI_DecodeCache_t self, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size);
+/**@}*/
+
+/**
+ * @addtogroup MDI_Program
+ */
+/**@{*/
+
+/**
+ * @brief Create a new Program
+ *
+ * Decode successively the Operations of the buffer from its start
+ * with the given Decoder, until the end of the buffer or the first
+ * Operation that can't be decoded, see MDI_Program_stop().
+ * The Decoder is not referenced after construction.
+ *
+ * @param self_ref A reference to the Program object to construct.
+ * @param decoder The Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer, at most 4GB.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Program_init(MDI_Program_t *self_ref, MDI_Decoder_t decoder, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_object_t params);
+
+/**
+ * @brief Destroy a Program
+ *
+ * Destruct a valid Program object.
+ *
+ * @param self_ref A reference to a valid Program object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Program_fini(MDI_Program_t *self_ref);
+
+/**
+ * @brief Number of Operations of a Program
+ *
+ * @param self A Program.
+ * @return The number of decoded Operations, the size of the Program arrays.
+ */
+MDI_INTERFACE MDI_size_t MDI_Program_count(MDI_Program_t self);
+
+/**
+ * @brief Decoded size of a Program
+ *
+ * @param self A Program.
+ * @return The number of buffer bytes decoded into Operations.
+ */
+MDI_INTERFACE MDI_size_t MDI_Program_size(MDI_Program_t self);
+
+/**
+ * @brief Decode stop reason of a Program
+ *
+ * @param self A Program.
+ * @return The MDI_DECODE_STOP_* reason, MDI_DECODE_STOP_END if the whole buffer was decoded.
+ */
+MDI_INTERFACE MDI_res_t MDI_Program_stop(MDI_Program_t self);
+
+/**
+ * @brief Operator indexes of a Program
+ *
+ * @param self A Program.
+ * @return The array of the Operations Operator indexes.
+ */
+MDI_INTERFACE const uint16_t *MDI_Program_operators(MDI_Program_t self);
+
+/**
+ * @brief Offsets of a Program
+ *
+ * @param self A Program.
+ * @return The array of the Operations offsets in the decoded buffer, increasing.
+ */
+MDI_INTERFACE const uint32_t *MDI_Program_offsets(MDI_Program_t self);
+
+/**
+ * @brief Sizes of a Program
+ *
+ * @param self A Program.
+ * @return The array of the Operations encoded sizes.
+ */
+MDI_INTERFACE const uint32_t *MDI_Program_sizes(MDI_Program_t self);
+
+/**
+ * @brief Operands starts of a Program
+ *
+ * The operands of the Operation idx are the operands slab values
+ * from index starts[idx] to starts[idx + 1] excluded.
+ *
+ * @param self A Program.
+ * @return The array of count + 1 Operations operands starts.
+ */
+MDI_INTERFACE const uint32_t *MDI_Program_operand_starts(MDI_Program_t self);
+
+/**
+ * @brief Operands slab of a Program
+ *
+ * @param self A Program.
+ * @return The array of all Operations operands, see MDI_Program_operand_starts().
+ */
+MDI_INTERFACE const intptr_t *MDI_Program_operands(MDI_Program_t self);
+
+/**
+ * @brief Find an Operation of a Program
+ *
+ * @param self A Program.
+ * @param offset A buffer offset.
+ * @return The index of the Operation starting at offset or -1.
+ */
+MDI_INTERFACE MDI_size_t MDI_Program_find(MDI_Program_t self, MDI_size_t offset);
+
+/**
+ * @brief Construct an Operation of a Program
+ *
+ * Construct the Operation idx in the given storage, as for
+ * MDI_Operation_init_storage(), with a DecodeInfo for the given
+ * buffer. The storage size for the Decoder is always enough,
+ * see MDI_Decoder_storage_size().
+ *
+ * @param self A Program.
+ * @param idx The Operation index.
+ * @param storage The Operation storage.
+ * @param storage_size The storage size.
+ * @param buffer The decoded buffer pointer for the DecodeInfo.
+ * @return The constructed Operation, or @c NULL on failure.
+ */
+MDI_INTERFACE MDI_Operation_t MDI_Program_operation(MDI_Program_t self, MDI_size_t idx, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_ptr_t buffer);
+/**@}*/
+
+/**
+ * @addtogroup MDI_Disassembler
+ */
+/**@{*/
+
+/**
+ * @brief Create a new Disassembler
+ *
+ * Create a new disassembler instance for the given machine description
+ * and the processor.
+ *
+ * @param self_ref A reference to the Disassembler object to construct.
+ * @param mdi A MDI machine description instance
+ * @param processor The Processor to disassembler for.
+ * @param params Implementaion defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Disassembler_init(MDI_Disassembler_t *self_ref, MDI_interface_t mdi, MDI_Processor_t processor, MDI_object_t params);
+
+/**
+ * @brief Destroy a Disassembler instance
+ *
+ * Destructor for a Disassembler instance.
+ *
+ * @param self_ref A reference to a valid Disassembler instance.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Disassembler_fini(MDI_Disassembler_t *self_ref);
+
+/**
+ * @brief Disassemble an Operation into an assembly buffer
+ *
+ * The Operation is disassembled at the location referenced by current_ptr
+ * inside the given disassembly buffer of size buffer_size.
+ * The returned value is the size in bytes necessary for the disassembly, if
+ * the output has been truncated, the returned size is greater or equal to
+ * the maximum usable size. I.e. the value of current_ptr on entry plus the
+ * returned size if greater or equal to the buffer limit (buffer + buffer_size).
+ * In this case also the returned current_ptr will point to the buffer limit
+ * (buffer + buffer_size). The emitted bytes are always '\0' terminated even
+ * when truncated. Nothing is emitted when current_ptr is already at the
+ * buffer limit.
+ *
+ * @param self the Disassembler
+ * @param operation The operation to disassemble.
+ * @param buffer The Disassembly buffer.
+ * @param buffer_size The disassembky buffer_size.
+ * @param current_ptr The current pointer into the disassembly buffer.
+ * @return The number of bytes necessary, may be larger than the emitted bytes.
+ */
+MDI_INTERFACE MDI_size_t MDI_Disassembler_disassemble(MDI_Disassembler_t self, MDI_Operation_t operation, MDI_ptr_mut_t buffer, MDI_size_t buffer_size, MDI_ptr_mut_t *current_ptr);
+/**@}*/
+
+/**
+ * @addtogroup MDI_Execution
+ */
+/**@{*/
+
+/**
+ * @brief Create a new Execution context
+ *
+ * Create a new execution instance for the given machine description
+ * and processor.
+ *
+ * @param self_ref A reference to the Execution object to construct.
+ * @param mdi A MDI machine description instance
+ * @param processor The Processor to decode for.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_init(MDI_Execution_t *self_ref, MDI_interface_t mdi, MDI_Processor_t processor, MDI_object_t params);
+
+/**
+ * @brief Destroy an Execution context
+ *
+ * Destruct a valid Execution object.
+ *
+ * @param self_ref A reference to a valid Execution object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_fini(MDI_Execution_t *self_ref);
+
+/**
+ * @brief Bind an Operation for execution
+ *
+ * Resolve once the execution handler and the size of the Operation
+ * for the Execution context and keep them in the Operation, such
+ * that following MDI_Execution_execute() of the Operation, for
+ * instance a loop body held in a DecodeCache, dispatch directly.
+ * MDI_Execution_execute() binds unbound Operations itself, the binding
+ * is kept until the Operation is destroyed or its DecodeInfo is set,
+ * and is implementation defined for other Execution contexts.
+ *
+ * @param self An Execution context.
+ * @param operation A decoded Operation.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_bind(MDI_Execution_t self, MDI_Operation_t operation);
+
+/**
+ * @brief Execute an Operation
+ *
+ * Execute an Operation, changing the current Execution state.
+ *
+ * @param self An Execution context.
+ * @param operation The Operation to execute.
+ * @return 0 on success, >0 for requesting more Operation, <0 on failure.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_execute(MDI_Execution_t self, MDI_Operation_t operation);
+
+/**
+ * @name Execution run stop reasons
+ *
+ * Reasons for an Execution run to return, failures are
+ * reported as negative values.
+ * @{
+ */
+#define MDI_EXECUTION_STOP_STEPS 1  /**< The steps budget is exhausted. */
+#define MDI_EXECUTION_STOP_PC 2     /**< The stop Program Counter was reached. */
+#define MDI_EXECUTION_STOP_LOOP 3   /**< An Operation branched to itself. */
+#define MDI_EXECUTION_STOP_EXIT 4   /**< The Program Counter left the executed code. */
+#define MDI_EXECUTION_FAULT_EXECUTE (-1)/**< An Operation execution failed. */
+#define MDI_EXECUTION_FAULT_DECODE (-2)/**< No valid Operation at the Program Counter. */
+/**@}*/
+
+/**
+ * @brief Run a ThreadedCode
+ *
+ * Execute the ThreadedCode Operations from the current Program
+ * Counter until one of the MDI_EXECUTION_STOP_* conditions occurs
+ * or an Operation execution fails.
+ * The conditions are checked after each executed Operation, in the
+ * order: failure, branch to itself, stop Program Counter, steps
+ * budget and exit of the translated code.
+ *
+ * @param self An Execution context.
+ * @param code A ThreadedCode translated for this Execution.
+ * @param max_steps The maximum number of Operations to execute or 0 for no limit.
+ * @param stop_pc The Program Counter to stop at or -1 for none.
+ * @param steps_ref A reference receiving the number of executed Operations, may be @c NULL.
+ * @return The stop reason, <0 on failure.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_run_threaded(MDI_Execution_t self, MDI_ThreadedCode_t code, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref);
+
+/**
+ * @brief Run from a code buffer
+ *
+ * Fetch, decode and execute the Operations of the code buffer from
+ * the current Program Counter, taken as an offset in the buffer,
+ * until one of the MDI_EXECUTION_STOP_* conditions occurs or a
+ * fault. The conditions are checked after each executed Operation
+ * as for MDI_Execution_run_threaded(), except that
+ * MDI_EXECUTION_STOP_EXIT is never returned.
+ * Decoded Operations are kept by the Execution context for the
+ * following runs over the same buffer, hence the buffer content
+ * must not change between runs.
+ * On MDI_EXECUTION_FAULT_DECODE the Program Counter is left at the
+ * undecodable location.
+ *
+ * @param self An Execution context.
+ * @param buffer The code buffer.
+ * @param size The code buffer size.
+ * @param max_steps The maximum number of Operations to execute or 0 for no limit.
+ * @param stop_pc The Program Counter to stop at or -1 for none.
+ * @param steps_ref A reference receiving the number of executed Operations, may be @c NULL.
+ * @return The stop reason, a MDI_EXECUTION_FAULT_* (<0) on failure.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_run(MDI_Execution_t self, MDI_ptr_t buffer, MDI_size_t size, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref);
+
+/**
+ * @brief Set the predecoded file for runs
+ *
+ * Set the predecoded file used by MDI_Execution_run() when it
+ * decodes a new code buffer, see MDI_Decoder_predecode().
+ * The file name is copied.
+ *
+ * @param self An Execution context.
+ * @param fname The predecoded file name or @c NULL for none.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_set_predecode(MDI_Execution_t self, MDI_str_t fname);
+
+/**
+ * @brief Execution context current Program Counter
+ *
+ * Helper to get the canonical PC value for the current
+ * Execution context if available.
+ * Implementation defined if the Program Counter is not
+ * available.
+ *
+ * @param self An Execution context.
+ * @return The current abstract Program Counter value.
+ */
+MDI_INTERFACE MDI_size_t MDI_Execution_pc(MDI_Execution_t self);
+
+/**
+ * @brief Execution context current return value
+ *
+ * Helper to get the ABI defined first return value if
+ * available.
+ * Implementation defined if the ABI return value is not
+ * available.
+ *
+ * @param self An Execution context.
+ * @return The current abstract first return value.
+ */
+MDI_INTERFACE uint64_t MDI_Execution_ret0(MDI_Execution_t self);
+
+/**
+ * @brief Pre execution step debug helper
+ *
+ * Helper called before execution of an Operation.
+ * The implementation should be empty, this is used as a helper
+ * for adding debugger breakpoints before execution.
+ *
+ * @param self An Execution context
+ */
+MDI_INTERFACE void MDI_Execution_stepin(MDI_Execution_t self);
+
+/**
+ * @brief Post execution step debug helper
+ *
+ * Helper called after execution of an Operation.
+ * The implementation should be empty, this is used as a helper
+ * for adding debugger breakpoints after execution.
+ *
+ * @param self An Execution context
+ */
+MDI_INTERFACE void MDI_Execution_stepout(MDI_Execution_t self);
+/**@}*/
+
+/**
+ * @addtogroup MDI_ThreadedCode
+ */
+/**@{*/
+
+/**
+ * @brief Create a new ThreadedCode
+ *
+ * Translate an array of decoded Operations for the given Execution
+ * context. Operations must have a DecodeInfo, their decode offsets
+ * being their Program Counter values. The Operations are not
+ * referenced after translation and may be destroyed.
+ *
+ * @param self_ref A reference to the ThreadedCode object to construct.
+ * @param execution The Execution context the code is translated for.
+ * @param operations The array of Operations to translate.
+ * @param count The number of Operations.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_ThreadedCode_init(MDI_ThreadedCode_t *self_ref, MDI_Execution_t execution, const MDI_Operation_t *operations, MDI_size_t count, MDI_object_t params);
+
+/**
+ * @brief Create a new ThreadedCode from a Program
+ *
+ * Translate all the Operations of a Program for the given Execution
+ * context, as for MDI_ThreadedCode_init(), the Program offsets
+ * being the Program Counter values. The Program is not referenced
+ * after translation.
+ *
+ * @param self_ref A reference to the ThreadedCode object to construct.
+ * @param execution The Execution context the code is translated for.
+ * @param program The Program to translate.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_ThreadedCode_init_program(MDI_ThreadedCode_t *self_ref, MDI_Execution_t execution, MDI_Program_t program, MDI_object_t params);
+
+/**
+ * @brief Destroy a ThreadedCode
+ *
+ * Destruct a valid ThreadedCode object.
+ *
+ * @param self_ref A reference to a valid ThreadedCode object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_ThreadedCode_fini(MDI_ThreadedCode_t *self_ref);
+/**@}*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* _MDI_OPERATIONS_H_INCLUDED */
+
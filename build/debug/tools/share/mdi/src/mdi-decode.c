@@ -0,0 +1,550 @@
+/*
+ * Machine Description Interface C API
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+
+static int verbose = 2;
+static int jobs = 1;
+static int indexed = 0;
+static const char *predecode_fname = NULL;
+
+/* Input is read by chunks, Operations are decoded and printed by batches. */
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE (1024 * 1024)
+#endif
+#define BATCH_SIZE 256
+
+/*
+ * Map a regular file input, read only, with sequential access hints.
+ * Returns 0 on success, otherwise the input must be read by chunks.
+ */
+int map_input(FILE *input, const char **buffer_ref, size_t *size_ref)
+{
+    struct stat st;
+    void *map;
+
+    if (fstat(fileno(input), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+        return -1;
+    if ((uint64_t)st.st_size != (uint64_t)(size_t)st.st_size)
+        return -1;
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(input), 0);
+    if (map == MAP_FAILED)
+        return -1;
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+    *buffer_ref = (const char *)map;
+    *size_ref = (size_t)st.st_size;
+    return 0;
+}
+
+int print(MDI_Disassembler_t disassembler, MDI_Operation_t *list, size_t list_size, FILE *output)
+{
+    char buffer[256];
+    size_t i;
+
+    for (i = 0; i < list_size; i++) {
+        MDI_ptr_mut_t next = buffer;
+        MDI_size_t nbytes = MDI_Disassembler_disassemble(disassembler, list[i], buffer, sizeof(buffer), &next);
+        if ((size_t)nbytes >= sizeof(buffer)) {
+            fprintf(stderr, "not enough space to print");
+            return -1;
+        }
+        fprintf(output, "  %s\n", buffer);
+    }
+    return 0;
+}
+
+/*
+ * Parallel decode of a buffer range with its own Decoder, the output
+ * is kept in memory for printing in order.
+ */
+typedef struct {
+    MDI_interface_t interface;
+    const char *buffer;
+    size_t start, end;
+    size_t current;
+    size_t opcount;
+    char *log_text, *output_text;
+    size_t log_size, output_size;
+    int rcode;
+} chunk_t;
+
+void *decode_chunk(void *arg)
+{
+    chunk_t *chunk = (chunk_t *)arg;
+    MDI_Operation_t *operations = NULL;
+    MDI_Decoder_t decoder = NULL;
+    MDI_Disassembler_t disassembler = NULL;
+    MDI_OperationPool_t pool = NULL;
+    MDI_DecodeInfo_t decode_info;
+    FILE *log = NULL, *output = NULL;
+    const char *current_ptr;
+    size_t count, i;
+    MDI_res_t stop;
+
+    chunk->rcode = -1;
+    chunk->current = chunk->start;
+    operations = (MDI_Operation_t *)malloc(BATCH_SIZE * sizeof(MDI_Operation_t));
+    log = open_memstream(&chunk->log_text, &chunk->log_size);
+    output = open_memstream(&chunk->output_text, &chunk->output_size);
+    if (operations == NULL || log == NULL || output == NULL) goto end_of_chunk;
+    if (MDI_Decoder_init(&decoder, chunk->interface, (MDI_Processor_t)0, NULL) != 0) goto end_of_chunk;
+    if (MDI_Disassembler_init(&disassembler, chunk->interface, (MDI_Processor_t)0, NULL) != 0) goto end_of_chunk;
+    if (MDI_OperationPool_init(&pool, 0, NULL) != 0) goto end_of_chunk;
+    MDI_Decoder_set_pool(decoder, pool);
+
+    /* Decode up to the range end only, from the whole buffer for identical DecodeInfo. */
+    current_ptr = chunk->buffer + chunk->start;
+    do {
+        count = MDI_Decoder_decode_batch(decoder, chunk->buffer, chunk->end, (MDI_ptr_t *)&current_ptr,
+                                         operations, BATCH_SIZE, &stop);
+        for (i = 0; i < count; i++) {
+            if (verbose >= 2) {
+                decode_info = MDI_Operation_decode_info(operations[i]);
+                fprintf(log, "  decoded operation at offset: %"PRIiPTR", next: %"PRIiPTR"\n",
+                        MDI_DecodeInfo_offset(decode_info),
+                        MDI_DecodeInfo_offset(decode_info) + MDI_DecodeInfo_size(decode_info));
+            }
+        }
+        if (print(disassembler, operations, count, output) != 0) goto end_of_chunk;
+        chunk->opcount += count;
+        MDI_OperationPool_reset(pool);
+    } while (stop == MDI_DECODE_STOP_COUNT);
+    chunk->current = current_ptr - chunk->buffer;
+    if (stop == MDI_DECODE_STOP_END) chunk->rcode = 0;
+ end_of_chunk:
+    if (pool != NULL) MDI_OperationPool_fini(&pool);
+    if (disassembler != NULL) MDI_Disassembler_fini(&disassembler);
+    if (decoder != NULL) MDI_Decoder_fini(&decoder);
+    if (output != NULL) fclose(output);
+    if (log != NULL) fclose(log);
+    free(operations);
+    return NULL;
+}
+
+int decode_parallel(MDI_interface_t interface, MDI_Decoder_t decoder, const char *buffer, size_t nbytes,
+                    const char *input_fname, FILE *output, size_t *opcount_ref, size_t *nbytes_ref)
+{
+    int rcode = -1;
+    chunk_t *chunks = NULL;
+    pthread_t *threads = NULL;
+    char *started = NULL;
+    MDI_size_t *bounds = NULL;
+    MDI_size_t count, i;
+
+    bounds = (MDI_size_t *)malloc((jobs + 1) * sizeof(MDI_size_t));
+    if (bounds == NULL) goto end_of_parallel;
+    count = MDI_Decoder_split(decoder, buffer, nbytes, jobs, bounds);
+    chunks = (chunk_t *)calloc(count, sizeof(chunk_t));
+    threads = (pthread_t *)calloc(count, sizeof(pthread_t));
+    started = (char *)calloc(count, sizeof(char));
+    if (chunks == NULL || threads == NULL || started == NULL) goto end_of_parallel;
+
+    for (i = 0; i < count; i++) {
+        chunks[i].interface = interface;
+        chunks[i].buffer = buffer;
+        chunks[i].start = bounds[i];
+        chunks[i].end = bounds[i + 1];
+        started[i] = pthread_create(&threads[i], NULL, decode_chunk, &chunks[i]) == 0;
+        if (!started[i]) decode_chunk(&chunks[i]);
+    }
+
+    /* Stitch the results in order, up to the first failing range. */
+    *opcount_ref = 0;
+    for (i = 0; i < count; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+    for (i = 0; i < count; i++) {
+        if (chunks[i].log_text != NULL) fwrite(chunks[i].log_text, 1, chunks[i].log_size, stderr);
+        if (chunks[i].output_text != NULL) fwrite(chunks[i].output_text, 1, chunks[i].output_size, output);
+        *opcount_ref += chunks[i].opcount;
+        *nbytes_ref = chunks[i].current;
+        if (chunks[i].rcode != 0) {
+            fprintf(stderr, "%s: invalid operation at offset: %"PRIuPTR"\n", input_fname, chunks[i].current);
+            goto end_of_parallel;
+        }
+    }
+    rcode = 0;
+ end_of_parallel:
+    if (chunks != NULL) {
+        for (i = 0; i < count; i++) {
+            free(chunks[i].log_text);
+            free(chunks[i].output_text);
+        }
+    }
+    free(started);
+    free(threads);
+    free(chunks);
+    free(bounds);
+    return rcode;
+}
+
+/*
+ * Check an index of the Operation starts of a buffer range against
+ * the successive decodes from the range start.
+ * Ranges starting at the indexed Operations cover unaligned starts,
+ * single Operation ranges cover buffers shorter than a vector.
+ */
+int check_index(MDI_Decoder_t decoder, const char *buffer, size_t start, size_t end, const uint32_t *offsets, size_t count)
+{
+    uint32_t *sub_offsets;
+    size_t sub_count, i, k;
+
+    sub_offsets = (uint32_t *)malloc((count + 1) * sizeof(uint32_t));
+    if (sub_offsets == NULL) return -1;
+    for (k = start; k < count && k < start + 32; k++) {
+        sub_count = MDI_Decoder_index(decoder, buffer + offsets[k], end - offsets[k], sub_offsets, count - k);
+        if (sub_count != count - k) break;
+        for (i = 0; i < sub_count; i++) {
+            if (sub_offsets[i] != offsets[k + i] - offsets[k]) break;
+        }
+        if (i < sub_count) break;
+        sub_count = MDI_Decoder_index(decoder, buffer + offsets[k], (k + 1 < count ? offsets[k + 1]: end) - offsets[k],
+                                      sub_offsets, 1);
+        if (sub_count != 1 || sub_offsets[0] != 0) break;
+    }
+    free(sub_offsets);
+    return k < count && k < start + 32 ? -1: 0;
+}
+
+/*
+ * Random access decode of each indexed Operation start, which must
+ * end at the next indexed start as for a successive decode.
+ */
+int decode_indexed(MDI_Decoder_t decoder, MDI_Disassembler_t disassembler, MDI_OperationPool_t pool,
+                   const char *buffer, size_t nbytes, const char *input_fname, FILE *output,
+                   size_t *opcount_ref, size_t *nbytes_ref)
+{
+    static MDI_Operation_t oplist[BATCH_SIZE];
+    int rcode = -1;
+    uint32_t *offsets = NULL;
+    const char *current_ptr;
+    size_t count, next, batch, i;
+    MDI_DecodeInfo_t decode_info;
+
+    if ((uint64_t)nbytes > UINT32_MAX) {
+        fprintf(stderr, "%s: input too large to be indexed\n", input_fname);
+        return -1;
+    }
+    count = MDI_Decoder_index(decoder, buffer, nbytes, NULL, 0);
+    offsets = (uint32_t *)malloc((count + 1) * sizeof(uint32_t));
+    if (offsets == NULL) {
+        fprintf(stderr, "error allocating index\n");
+        return -1;
+    }
+    if (MDI_Decoder_index(decoder, buffer, nbytes, offsets, count) != count ||
+        check_index(decoder, buffer, 0, nbytes, offsets, count) != 0) {
+        fprintf(stderr, "%s: inconsistent index\n", input_fname);
+        goto end_of_indexed;
+    }
+
+    *opcount_ref = 0;
+    *nbytes_ref = 0;
+    for (batch = 0; batch < count; batch += i) {
+        for (i = 0; i < BATCH_SIZE && batch + i < count; i++) {
+            current_ptr = buffer + offsets[batch + i];
+            next = batch + i + 1 < count ? offsets[batch + i + 1]: nbytes;
+            oplist[i] = MDI_Decoder_decode(decoder, buffer, nbytes, (MDI_ptr_t *)&current_ptr);
+            if (oplist[i] == NULL || current_ptr != buffer + next) {
+                fprintf(stderr, "%s: invalid operation at index %"PRIuPTR", offset: %"PRIu32"\n",
+                        input_fname, batch + i, offsets[batch + i]);
+                goto end_of_indexed;
+            }
+            if (verbose >= 2) {
+                decode_info = MDI_Operation_decode_info(oplist[i]);
+                fprintf(stderr, "  decoded operation at offset: %"PRIiPTR", next: %"PRIiPTR"\n",
+                        MDI_DecodeInfo_offset(decode_info),
+                        MDI_DecodeInfo_offset(decode_info) + MDI_DecodeInfo_size(decode_info));
+            }
+        }
+        if (print(disassembler, oplist, i, output) != 0) goto end_of_indexed;
+        *opcount_ref += i;
+        *nbytes_ref = batch + i < count ? offsets[batch + i]: nbytes;
+        MDI_OperationPool_reset(pool);
+    }
+    rcode = 0;
+ end_of_indexed:
+    free(offsets);
+    return rcode;
+}
+
+int decode(MDI_interface_t interface, MDI_OperationPool_t pool, const char *input_fname, const char *output_fname)
+{
+    static MDI_Operation_t oplist[BATCH_SIZE];
+    int rcode = -1;
+    FILE *input = NULL;
+    FILE *output = NULL;
+    char *chunk = NULL;
+    const char *buffer = NULL;
+    const char *current_ptr;
+    size_t nbytes = 0, nread, carry;
+    size_t origin = 0;
+    size_t opcount = 0;
+    size_t count, i;
+    int eof = 0, mapped = 0;
+    MDI_Decoder_t decoder = NULL;
+    MDI_Disassembler_t disassembler = NULL;
+    MDI_DecodeInfo_t decode_info;
+    MDI_res_t res, stop;
+
+    if (strcmp(input_fname, "-") == 0) {
+        input = stdin;
+    } else {
+        input = fopen(input_fname, "rb");
+        if (input == NULL) {
+            fprintf(stderr, "error opening %s: ", input_fname);
+            perror("");
+            goto end_of_decode;
+        }
+    }
+
+    if (strcmp(output_fname, "-") == 0) {
+        output = stdout;
+    } else {
+        output = fopen(output_fname, "w");
+        if (output == NULL) {
+            fprintf(stderr, "error opening %s: ", output_fname);
+            perror("");
+            goto end_of_decode;
+        }
+    }
+
+    /* Decode directly from the file mapping when possible, otherwise by chunks. */
+    mapped = map_input(input, &buffer, &nbytes) == 0;
+    if (!mapped) {
+        chunk = (char *)malloc(CHUNK_SIZE);
+        if (chunk == NULL) {
+            fprintf(stderr, "error allocating input buffer\n");
+            goto end_of_decode;
+        }
+        buffer = chunk;
+    }
+
+    if (verbose >= 1) {
+        fprintf(stderr, "Start of Decode\n");
+    }
+
+    res = MDI_Decoder_init(&decoder, interface, (MDI_Processor_t)0, NULL);
+    if (res != 0) {
+        fprintf(stderr, "error constructing Decoder");
+        goto end_of_decode;
+    }
+    MDI_Decoder_set_pool(decoder, pool);
+
+    if (verbose >= 1) {
+        fprintf(stderr, "Start of Disassembly\n");
+    }
+
+    res = MDI_Disassembler_init(&disassembler, interface, (MDI_Processor_t)0, NULL);
+    if (res != 0) {
+        fprintf(stderr, "error constructing Disassembler");
+        goto end_of_decode;
+    }
+
+    /* A predecoded file replaces the parsing, the decode is then sequential. */
+    if (predecode_fname != NULL) {
+        if (!mapped) {
+            fprintf(stderr, "%s: predecoded file ignored for a non regular input\n", input_fname);
+        } else if (MDI_Decoder_predecode(decoder, buffer, nbytes, predecode_fname) != 0) {
+            fprintf(stderr, "%s: can't use predecoded file: %s\n", input_fname, predecode_fname);
+        }
+    }
+
+    /* The indexed decode needs the whole input, in place of the other decodes. */
+    if (indexed) {
+        if (!mapped) {
+            fprintf(stderr, "%s: index ignored for a non regular input\n", input_fname);
+        } else {
+            if (decode_indexed(decoder, disassembler, pool, buffer, nbytes, input_fname, output, &opcount, &origin) != 0)
+                goto end_of_decode;
+            eof = 1;
+        }
+    }
+
+    if (!eof && mapped && jobs > 1 && predecode_fname == NULL) {
+        if (decode_parallel(interface, decoder, buffer, nbytes, input_fname, output, &opcount, &origin) != 0)
+            goto end_of_decode;
+        eof = 1;
+    }
+
+    while (!eof) {
+        if (mapped) {
+            eof = 1;
+        } else {
+            nread = fread(chunk + nbytes, 1, CHUNK_SIZE - nbytes, input);
+            if (nread < CHUNK_SIZE - nbytes) {
+                if (ferror(input)) {
+                    fprintf(stderr, "error while reading %s: ", input_fname);
+                    perror("");
+                    goto end_of_decode;
+                }
+                eof = 1;
+            }
+            nbytes += nread;
+        }
+
+        MDI_Decoder_set_origin(decoder, origin);
+        current_ptr = buffer;
+        do {
+            count = MDI_Decoder_decode_batch(decoder, buffer, nbytes, (MDI_ptr_t *)&current_ptr,
+                                             oplist, BATCH_SIZE, &stop);
+            /*
+             * Before the end of input, an Operation ending at the chunk
+             * limit may have trailing spaces in the next chunk, decode
+             * it again with the next chunk.
+             */
+            if (!eof && count > 0 && current_ptr == buffer + nbytes) {
+                count--;
+                decode_info = MDI_Operation_decode_info(oplist[count]);
+                current_ptr = buffer + (MDI_DecodeInfo_offset(decode_info) - origin);
+                stop = MDI_DECODE_STOP_PARTIAL;
+            }
+            for (i = 0; i < count; i++) {
+                if (verbose >= 2) {
+                    decode_info = MDI_Operation_decode_info(oplist[i]);
+                    fprintf(stderr, "  decoded operation at offset: %"PRIiPTR", next: %"PRIiPTR"\n",
+                            MDI_DecodeInfo_offset(decode_info),
+                            MDI_DecodeInfo_offset(decode_info) + MDI_DecodeInfo_size(decode_info));
+                }
+            }
+            if (print(disassembler, oplist, count, output) != 0) goto end_of_decode;
+            opcount += count;
+            /* Printed Operations are released. */
+            MDI_OperationPool_reset(pool);
+        } while (stop == MDI_DECODE_STOP_COUNT);
+        if (stop != MDI_DECODE_STOP_END && (eof || stop != MDI_DECODE_STOP_PARTIAL)) {
+            fprintf(stderr, "%s: invalid operation at offset: %"PRIuPTR"\n", input_fname,
+                    origin + (current_ptr - buffer));
+            goto end_of_decode;
+        }
+
+        /* Carry over the partial trailing Operation. */
+        carry = buffer + nbytes - current_ptr;
+        origin += nbytes - carry;
+        if (eof) break;
+        memmove(chunk, current_ptr, carry);
+        nbytes = carry;
+        if (nbytes == CHUNK_SIZE) {
+            fprintf(stderr, "%s: operation too large at offset: %"PRIuPTR"\n", input_fname, origin);
+            goto end_of_decode;
+        }
+    }
+
+    if (verbose >= 1) {
+        fprintf(stdout, "End of Decode. (%"PRIuPTR" operations, %"PRIuPTR" bytes)\n",
+                opcount, origin);
+        fprintf(stdout, "End of Disassembly.\n");
+    }
+    rcode = 0;
+ end_of_decode:
+    if (disassembler != NULL) MDI_Disassembler_fini(&disassembler);
+    if (decoder != NULL) MDI_Decoder_fini(&decoder);
+    if (mapped) munmap((void *)buffer, nbytes);
+    free(chunk);
+    if (output != NULL && output != stdout) fclose(output);
+    if (input != NULL && input != stdin) fclose(input);
+    return rcode;
+}
+
+int main(int argc, char *argv[])
+{
+    char *input_fname, *output_fname;
+    int rcode;
+    MDI_interface_t interface;
+    MDI_OperationPool_t pool;
+
+    while (argc >= 3 && (strcmp(argv[1], "-j") == 0 || strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "-i") == 0)) {
+        if (strcmp(argv[1], "-i") == 0) {
+            indexed = 1;
+            argc--;
+            argv++;
+            continue;
+        }
+        if (strcmp(argv[1], "-j") == 0) {
+            jobs = atoi(argv[2]);
+            if (jobs < 1) {
+                fprintf(stderr, "invalid jobs count: %s\n", argv[2]);
+                exit(1);
+            }
+        } else {
+            predecode_fname = argv[2];
+        }
+        argc -= 2;
+        argv += 2;
+    }
+    if (argc < 3) {
+        fprintf(stderr, "missign argument\n");
+        exit(1);
+    }
+    input_fname = argv[1];
+    output_fname = argv[2];
+
+    rcode = MDI_interface_init(&interface, NULL);
+    if (rcode != 0) {
+        fprintf(stderr, "can't initialize MDI interface\n");
+        exit(1);
+    }
+
+    rcode = MDI_OperationPool_init(&pool, 0, NULL);
+    if (rcode != 0) {
+        fprintf(stderr, "can't initialize Operation pool\n");
+        exit(1);
+    }
+
+    rcode = decode(interface, pool, input_fname, output_fname);
+    if (rcode != 0) {
+        fprintf(stderr, "error while decoding from %s\n", input_fname);
+        exit(1);
+    }
+
+    rcode = MDI_OperationPool_fini(&pool);
+    if (rcode != 0) {
+        fprintf(stderr, "can't destroy Operation pool\n");
+        exit(1);
+    }
+
+    rcode = MDI_interface_fini(&interface);
+    if (rcode != 0) {
+        fprintf(stderr, "can't destroy MDI interface\n");
+        exit(1);
+    }
+
+    return 0;
+}
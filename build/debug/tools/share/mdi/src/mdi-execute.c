@@ -0,0 +1,223 @@
+/*
+ * Machine Description Interface C API
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+
+static int verbose = 1;
+static const char *predecode_fname = NULL;
+
+#define CHUNK_SIZE (1024 * 1024)
+
+/*
+ * Map a regular file input, read only, without copy.
+ * Returns 0 on success, otherwise the input must be read.
+ */
+int map_input(FILE *input, char **buffer_ref, size_t *size_ref)
+{
+    struct stat st;
+    void *map;
+
+    if (fstat(fileno(input), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+        return -1;
+    if ((uint64_t)st.st_size != (uint64_t)(size_t)st.st_size)
+        return -1;
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(input), 0);
+    if (map == MAP_FAILED)
+        return -1;
+    madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+    *buffer_ref = (char *)map;
+    *size_ref = (size_t)st.st_size;
+    return 0;
+}
+
+/*
+ * Read the whole input, as execution needs random access to the code.
+ */
+int read_input(FILE *input, char **buffer_ref, size_t *size_ref)
+{
+    char *buffer = NULL, *new_buffer;
+    size_t size = 0, alloc = 0, nread;
+
+    do {
+        if (size == alloc) {
+            alloc = alloc == 0 ? CHUNK_SIZE: alloc * 2;
+            new_buffer = (char *)realloc(buffer, alloc);
+            if (new_buffer == NULL) {
+                free(buffer);
+                return -1;
+            }
+            buffer = new_buffer;
+        }
+        nread = fread(buffer + size, 1, alloc - size, input);
+        size += nread;
+    } while (nread > 0);
+    if (ferror(input)) {
+        free(buffer);
+        return -1;
+    }
+    *buffer_ref = buffer;
+    *size_ref = size;
+    return 0;
+}
+
+int execute(MDI_interface_t interface, const char *input_fname)
+{
+    char *buffer = NULL;
+    int rcode = -1;
+    FILE *input;
+    size_t nbytes;
+    int mapped = 0;
+    MDI_Execution_t execution = NULL;
+    MDI_res_t res;
+    MDI_size_t stop_pc, next_pc, steps;
+    uint64_t count = 0;
+
+    if (strcmp(input_fname, "-") == 0) {
+        input = stdin;
+    } else {
+        input = fopen(input_fname, "rb");
+        if (input == NULL) {
+            fprintf(stderr, "error opening %s: ", input_fname);
+            perror("");
+            goto end_of_execute;
+        }
+    }
+
+    mapped = map_input(input, &buffer, &nbytes) == 0;
+    if (!mapped && read_input(input, &buffer, &nbytes) != 0) {
+        fprintf(stderr, "error while reading %s: ", input_fname);
+        perror("");
+        goto end_of_execute;
+    }
+
+    res = MDI_Execution_init(&execution, interface, (MDI_Processor_t)0, NULL);
+    if (res != 0) {
+        fprintf(stderr, "error creating Execution\n");
+        goto end_of_execute;
+    }
+
+    if (predecode_fname != NULL) {
+        res = MDI_Execution_set_predecode(execution, predecode_fname);
+        if (res != 0) {
+            fprintf(stderr, "error setting predecoded file\n");
+            goto end_of_execute;
+        }
+    }
+
+    next_pc = MDI_Execution_pc(execution);
+    stop_pc = next_pc; /* Assume processor stopped if PC at reset is reach again. */
+    fprintf(stdout, "Start of execution at PC: %"PRIuPTR"\n", next_pc);
+
+    /* The code buffer is decoded and executed by the Execution context. */
+    res = MDI_Execution_run(execution, buffer, nbytes, 0, stop_pc, &steps);
+    count += steps;
+    next_pc = MDI_Execution_pc(execution);
+    if (res == MDI_EXECUTION_FAULT_DECODE) {
+        fprintf(stderr, "%s: invalid operation decode at PC: %"PRIuPTR"\n", input_fname, next_pc);
+        goto end_of_execute;
+    }
+    if (res < 0) {
+        fprintf(stderr, "%s: invalid operation execution at PC: %"PRIuPTR", after %"PRIu64" instructions\n",
+                input_fname, next_pc, count);
+        goto end_of_execute;
+    }
+    if (res == MDI_EXECUTION_STOP_LOOP) {
+        if (verbose >= 1) {
+            fprintf(stdout, "processor PC busy loop, assuming stopped at PC: %"PRIuPTR"\n",
+                    next_pc);
+        }
+    } else if (res == MDI_EXECUTION_STOP_PC) {
+        if (verbose >= 1) {
+            fprintf(stdout, "processor PC stop value, assuming reset at PC: %"PRIuPTR"\n",
+                    next_pc);
+        }
+    }
+
+    if (verbose >= 1) {
+        fprintf(stdout, "End of execution at PC: %"PRIuPTR"\n", MDI_Execution_pc(execution));
+        fprintf(stdout, "  Insrructions count: %"PRIu64"\n", count);
+        fprintf(stdout, "  Return value ret0: %"PRIu64"\n",
+                MDI_Execution_ret0(execution));
+    }
+    rcode = 0;
+ end_of_execute:
+    if (execution != NULL) MDI_Execution_fini(&execution);
+    if (mapped) munmap(buffer, nbytes);
+    else free(buffer);
+    if (input != NULL && input != stdin) fclose(input);
+    return rcode;
+}
+
+int main(int argc, char *argv[])
+{
+    char *input_fname;
+    int rcode;
+    MDI_interface_t interface;
+
+    if (argc >= 3 && strcmp(argv[1], "-c") == 0) {
+        predecode_fname = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+    if (argc < 2) {
+        fprintf(stderr, "missign argument\n");
+        exit(1);
+    }
+    input_fname = argv[1];
+
+    rcode = MDI_interface_init(&interface, NULL);
+    if (rcode != 0) {
+        fprintf(stderr, "can't initialize MDI interface\n");
+        exit(1);
+    }
+
+    rcode = execute(interface, input_fname);
+    if (rcode != 0) {
+        fprintf(stderr, "error while executing %s\n", input_fname);
+        exit(1);
+    }
+
+    rcode = MDI_interface_fini(&interface);
+    if (rcode != 0) {
+        fprintf(stderr, "can't destroy MDI interface\n");
+        exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+#!/usr/bin/env python
+#
+# Machine Description Interface C API
+#
+# This software is delivered under the terms of the MIT License
+#
+# Copyright (c) 2016 STMicroelectronics
+#
+# Permission is hereby granted, free of charge, to any person
+# obtaining a copy of this software and associated documentation
+# files (the "Software"), to deal in the Software without
+# restriction, including without limitation the rights to use,
+# copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following
+# conditions:
+#
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+# OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+# NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+# HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+# WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+# OTHER DEALINGS IN THE SOFTWARE.
+#
+#
+#
+# Converts MINI programs between the text encoding and the fixed width
+# binary encoding described in src/mdi_decoder.h.
+#
+# Usage: convert_encoding.py instructions.enum to-binary|to-text input output
+#
+# Operands used as code addresses are relocated as operation sizes
+# differ between encodings: PC relative offsets ("RR(PC,0) + P(n)")
+# and trap addresses ("RS(TRAP,P(n)) = P(m)").
+# The text output is canonical, one operation per line, the original
+# spacing is not preserved.
+#
+
+from __future__ import print_function
+import sys
+import re
+import struct
+
+BINARY_SIZE = 8
+
+class ENUM:
+
+    instructions_list = []
+    def __init__(self, ID, mnemonic, properties, parsing, encoding, short_desc, execution, description):
+        self.ID = ID
+        self.encoding = encoding
+        self.execution = execution
+        self.idx = len(self.instructions_list)
+        self.operands = []
+        regex = ""
+        for token in re.findall(r"%%|%[ud]|\s+|.", encoding):
+            if token == "%%": regex += "%"
+            elif token == "%u":
+                self.operands.append("unsigned")
+                regex += "([0-9]+)"
+            elif token == "%d":
+                self.operands.append("signed")
+                regex += "([-+]?[0-9]+)"
+            elif token.isspace(): regex += r"\s*"
+            else: regex += re.escape(token)
+        self.regex = re.compile(regex + "$")
+        self.pc_relative = [int(x) for x in re.findall(r"RR\(PC,\s*0\)\s*\+\s*P\((\d+)\)", execution)]
+        self.absolute = [int(x) for x in re.findall(r"RS\(TRAP,\s*P\(\d+\)\)\s*=\s*P\((\d+)\)", execution)]
+        self.instructions_list.append(self)
+
+class ConvertError(Exception):
+    pass
+
+def u32(value):
+    return value & 0xffffffff
+
+def s32(value):
+    value = u32(value)
+    return value - (1 << 32) if value & 0x80000000 else value
+
+def parse_text(data):
+    """
+    Returns the list of (offset, instruction, operands) of a text
+    encoded program, offset being the operation start as seen by
+    the decoder, i.e. including its leading spaces for the first one.
+    """
+    operations = []
+    pos = 0
+    start = 0
+    while True:
+        while pos < len(data) and data[pos].isspace(): pos += 1
+        if pos == len(data): break
+        end = data.find(".", pos)
+        if end < 0: raise ConvertError("truncated operation at offset %d" % start)
+        text = data[pos:end + 1]
+        for inst in ENUM.instructions_list:
+            match = inst.regex.match(text)
+            if match: break
+        else:
+            raise ConvertError("invalid operation at offset %d: %s" % (start, text))
+        operations.append((start, inst, [u32(int(x)) for x in match.groups()]))
+        pos = end + 1
+        while pos < len(data) and data[pos].isspace(): pos += 1
+        start = pos
+    return operations, start
+
+def parse_binary(data):
+    operations = []
+    if len(data) % BINARY_SIZE != 0:
+        raise ConvertError("truncated operation at offset %d" % (len(data) - len(data) % BINARY_SIZE))
+    for start in range(0, len(data), BINARY_SIZE):
+        fields = struct.unpack("<BBBBI", data[start:start + BINARY_SIZE])
+        if fields[0] == 0 or fields[0] > len(ENUM.instructions_list):
+            raise ConvertError("invalid operation at offset %d" % start)
+        inst = ENUM.instructions_list[fields[0] - 1]
+        count = len(inst.operands)
+        operands = list(fields[1:count]) + ([fields[4]] if count > 0 else [])
+        if any(fields[1 + i] != 0 for i in range(max(count - 1, 0), 3)) or (count == 0 and fields[4] != 0):
+            raise ConvertError("invalid operation at offset %d" % start)
+        operations.append((start, inst, operands))
+    return operations, len(data)
+
+def relocate(operations, end, new_offsets, new_end):
+    """
+    Returns the operations operands with code addresses relocated
+    from the operations offsets to new_offsets.
+    """
+    mapping = dict(zip([offset for (offset, inst, operands) in operations] + [end], new_offsets + [new_end]))
+    result = []
+    for (offset, new_offset, (_, inst, operands)) in zip([op[0] for op in operations], new_offsets, operations):
+        operands = list(operands)
+        for i in inst.pc_relative:
+            target = offset + s32(operands[i])
+            if target not in mapping:
+                raise ConvertError("branch at offset %d to %d is not an operation start" % (offset, target))
+            operands[i] = u32(mapping[target] - new_offset)
+        for i in inst.absolute:
+            if operands[i] not in mapping:
+                raise ConvertError("address at offset %d to %d is not an operation start" % (offset, operands[i]))
+            operands[i] = u32(mapping[operands[i]])
+        result.append(operands)
+    return result
+
+def emit_binary(operations, end):
+    new_offsets = [i * BINARY_SIZE for i in range(len(operations))]
+    relocated = relocate(operations, end, new_offsets, len(operations) * BINARY_SIZE)
+    data = b""
+    for ((offset, inst, _), operands) in zip(operations, relocated):
+        for value in operands[:-1]:
+            if value > 0xff:
+                raise ConvertError("operand %d of operation at offset %d does not fit in 8 bits" % (value, offset))
+        fields = (operands[:-1] + [0, 0, 0])[:3] + [operands[-1] if operands else 0]
+        data += struct.pack("<BBBBI", inst.idx + 1, *fields)
+    return data
+
+def format_text(inst, operands):
+    values = iter(operands)
+    def convert(match):
+        token = match.group(0)
+        if token == "%%": return "%"
+        if token == "%d": return str(s32(next(values)))
+        return str(next(values))
+    return re.sub(r"%%|%[ud]", convert, inst.encoding) + "\n"
+
+def emit_text(operations, end):
+    # Operation sizes depend on the relocated operands, grow them up to
+    # a fixed point and pad the shorter operations with trailing spaces.
+    sizes = [len(format_text(inst, operands)) for (offset, inst, operands) in operations]
+    while True:
+        new_offsets = [sum(sizes[:i]) for i in range(len(sizes))]
+        relocated = relocate(operations, end, new_offsets, sum(sizes))
+        lines = [format_text(inst, operands) for ((_, inst, _), operands) in zip(operations, relocated)]
+        new_sizes = [max(size, len(line)) for (size, line) in zip(sizes, lines)]
+        if new_sizes == sizes: break
+        sizes = new_sizes
+    return "".join([line[:-1] + " " * (size - len(line)) + "\n"
+                    for (line, size) in zip(lines, sizes)]).encode("ascii")
+
+def main(args):
+    if len(args) != 4 or args[1] not in ("to-binary", "to-text"):
+        print("usage: convert_encoding.py instructions.enum to-binary|to-text input output", file=sys.stderr)
+        return 2
+    exec(open(args[0]).read())
+    with open(args[2], "rb") as inf:
+        data = inf.read()
+    try:
+        if args[1] == "to-binary":
+            output = emit_binary(*parse_text(data.decode("ascii")))
+        else:
+            output = emit_text(*parse_binary(data))
+    except ConvertError as e:
+        print("convert_encoding.py: error: %s: %s" % (args[2], e), file=sys.stderr)
+        return 1
+    with open(args[3], "wb") as outf:
+        outf.write(output)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
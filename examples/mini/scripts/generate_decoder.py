@@ -0,0 +1,150 @@
+#!/usr/bin/env python
+#
+# Machine Description Interface C API
+#
+# This software is delivered under the terms of the MIT License
+#
+# Copyright (c) 2016 STMicroelectronics
+#
+# Permission is hereby granted, free of charge, to any person
+# obtaining a copy of this software and associated documentation
+# files (the "Software"), to deal in the Software without
+# restriction, including without limitation the rights to use,
+# copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following
+# conditions:
+#
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+# OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+# NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+# HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+# WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+# OTHER DEALINGS IN THE SOFTWARE.
+#
+#
+
+from __future__ import print_function
+import sys
+import re
+
+class ENUM:
+
+    instructions_list = []
+    def __init__(self, ID, mnemonic, properties, parsing, encoding, short_desc, execution, description):
+        self.ID = ID
+        self.mnemonic = mnemonic
+        self.properties = properties
+        self.parsing = parsing
+        self.encoding = encoding
+        self.short_desc = short_desc
+        self.execution = execution
+        self.description = description
+        self.instructions_list.append(self)
+
+    @staticmethod
+    def emit_decoder(out):
+        with open(out, "w") as outf:
+            print("/* BEGIN: Generated decoder */", file=outf)
+            ENUM._emit_decoder(outf)
+            print("/* END: Generated decoder */", file=outf)
+
+    @staticmethod
+    def _prefix(encoding):
+        return re.match(r"[^./]*", encoding).group(0)
+
+    @staticmethod
+    def _fields(inst):
+        """
+        Compiles the encoding format after the prefix into fields.
+        Supported format directives are literal characters, white
+        spaces (matching any number of spaces), "%u", "%d" and "%%".
+        """
+        fields = []
+        for token in re.findall(r"%%|%[ud]|%|\s+|.", inst.encoding[len(ENUM._prefix(inst.encoding)):]):
+            if token == "%%": fields.append(("literal", "%"))
+            elif token == "%u": fields.append(("unsigned", None))
+            elif token == "%d": fields.append(("signed", None))
+            elif token.isspace(): fields.append(("spaces", None))
+            else:
+                assert token != "%", "unsupported conversion in: %s" % inst.ID
+                fields.append(("literal", token))
+        return fields
+
+    @staticmethod
+    def _c_char(char):
+        return "'%s'" % {"\\": "\\\\", "'": "\\'"}.get(char, char)
+
+    @staticmethod
+    def _emit_match(out, idx, inst, depth, indent):
+        """ Emits the fields parsers and return for a matched prefix. """
+        operand = 0
+        print("%s/* %s: %s */" % (indent, inst.ID, inst.encoding), file=out)
+        print("%s_current += %i;" % (indent, depth), file=out)
+        for (kind, value) in ENUM._fields(inst):
+            if kind == "literal":
+                print("%sDEC_LITERAL(%s);" % (indent, ENUM._c_char(value)), file=out)
+            elif kind == "spaces":
+                print("%sDEC_SPACES();" % indent, file=out)
+            elif kind == "unsigned":
+                print("%sDEC_UNSIGNED(%i);" % (indent, operand), file=out)
+                operand += 1
+            elif kind == "signed":
+                print("%sDEC_SIGNED(%i);" % (indent, operand), file=out)
+                operand += 1
+        print("%sDEC_END(%i, %i);" % (indent, idx, operand), file=out)
+
+    @staticmethod
+    def _emit_trie(out, node, depth, indent):
+        """
+        Emits a switch on the prefix character at depth. The prefix
+        end is the '/' or '.' character following it.
+        """
+        print("%sswitch (_current[%i]) {" % (indent, depth), file=out)
+        if node["match"] is not None:
+            (idx, inst) = node["match"]
+            print("%scase '/': case '.':" % indent, file=out)
+            ENUM._emit_match(out, idx, inst, depth, indent + "  ")
+        for char in sorted(node["children"].keys()):
+            print("%scase %s:" % (indent, ENUM._c_char(char)), file=out)
+            ENUM._emit_trie(out, node["children"][char], depth + 1, indent + "  ")
+            print("%s  break;" % indent, file=out)
+        print("%s}" % indent, file=out)
+
+    @staticmethod
+    def _emit_decoder(out):
+        root = {"match": None, "children": {}}
+        operands_max = 0
+        idx = 0
+        for inst in ENUM.instructions_list:
+            node = root
+            for char in ENUM._prefix(inst.encoding):
+                node = node["children"].setdefault(char, {"match": None, "children": {}})
+            # First operator wins on duplicated prefixes.
+            if node["match"] is None:
+                node["match"] = (idx, inst)
+            operands_max = max(operands_max, len([kind for (kind, value) in ENUM._fields(inst)
+                                                  if kind in ("unsigned", "signed")]))
+            idx += 1
+        print("#define DEC_OPERANDS_MAX %i" % operands_max, file=out)
+        print("#define DEC_OPERATORS_COUNT %i" % len(ENUM.instructions_list), file=out)
+        print("", file=out)
+        print("static const uint8_t _decode_opcounts[] = {", file=out)
+        for inst in ENUM.instructions_list:
+            print("  %i /* %s */," % (len([kind for (kind, value) in ENUM._fields(inst)
+                                           if kind in ("unsigned", "signed")]), inst.ID), file=out)
+        print("};", file=out)
+        print("", file=out)
+        print("static int _decode_operation(const char *_current, const char *_limit, uint32_t *_operands, uint32_t *_operator_ref)", file=out)
+        print("{", file=out)
+        ENUM._emit_trie(out, root, 0, "  ")
+        print("  return -1;", file=out)
+        print("}", file=out)
+
+execfile(sys.argv[1])
+ENUM.emit_decoder(sys.argv[2])
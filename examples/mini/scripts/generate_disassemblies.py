@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+#
+# Machine Description Interface C API
+#
+# This software is delivered under the terms of the MIT License
+#
+# Copyright (c) 2016 STMicroelectronics
+#
+# Permission is hereby granted, free of charge, to any person
+# obtaining a copy of this software and associated documentation
+# files (the "Software"), to deal in the Software without
+# restriction, including without limitation the rights to use,
+# copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following
+# conditions:
+#
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+# OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+# NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+# HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+# WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+# OTHER DEALINGS IN THE SOFTWARE.
+#
+#
+
+from __future__ import print_function
+import sys
+import re
+
+class ENUM:
+
+    instructions_list = []
+    def __init__(self, ID, mnemonic, properties, parsing, encoding, short_desc, execution, description):
+        self.ID = ID
+        self.mnemonic = mnemonic
+        self.properties = properties
+        self.parsing = parsing
+        self.encoding = encoding
+        self.short_desc = short_desc
+        self.execution = execution
+        self.description = description
+        self.instructions_list.append(self)
+
+    @staticmethod
+    def emit_disassembly(out):
+        with open(out, "w") as outf:
+            print("/* BEGIN: Generated disassemblies */", file=outf)
+            ENUM._emit_disassemblies(outf)
+            print("/* END: Generated disassemblies */", file=outf)
+
+    @staticmethod
+    def _c_string(literal):
+        return '"%s"' % literal.replace("\\", "\\\\").replace('"', '\\"').replace("\t", "\\t").replace("\n", "\\n")
+
+    @staticmethod
+    def _fields(inst):
+        """
+        Splits the parsing format into a list of ("literal", text) and
+        (conversion, operand index) fields. The mnemonic %s is folded
+        into the literals.
+        """
+        fields = []
+        literal = ""
+        opidx = 0
+        mnemonic_done = False
+        for token in re.findall(r"%%|%[sud]|[^%]+", inst.parsing):
+            if token == "%%":
+                literal += "%"
+            elif token == "%s":
+                assert not mnemonic_done, "only the mnemonic %%s is supported: %s" % inst.ID
+                literal += inst.mnemonic
+                mnemonic_done = True
+            elif token in ("%u", "%d"):
+                if literal != "": fields.append(("literal", literal))
+                literal = ""
+                fields.append((token[1], opidx))
+                opidx += 1
+            else:
+                assert not token.startswith("%"), "unsupported conversion in: %s" % inst.ID
+                literal += token
+        if literal != "": fields.append(("literal", literal))
+        return fields
+
+    @staticmethod
+    def _emit_disassemblies(out):
+        max_length = 0
+        idx = 0
+        for inst in ENUM.instructions_list:
+            fields = ENUM._fields(inst)
+            conversions = [(kind, value) for (kind, value) in fields if kind != "literal"]
+            literals = sum([len(value) for (kind, value) in fields if kind == "literal"])
+            lengths = ["%i" % literals]
+            # At most 11 characters for a 32 bits decimal value.
+            max_length = max(max_length, literals + 11 * len(conversions))
+            print("", file=out)
+            print("static size_t _disassembly_length_%i /* %s */ (DIS_OPS_T _operands)" % (idx, inst.ID), file=out)
+            print("{", file=out)
+            if len(conversions) == 0:
+                print("  (void)_operands;", file=out)
+            for (kind, value) in conversions:
+                if kind == "u": lengths.append("DIS_ULEN(_operands[%i])" % value)
+                elif kind == "d": lengths.append("DIS_ILEN(_operands[%i])" % value)
+            print("  return %s;" % " + ".join(lengths), file=out)
+            print("}", file=out)
+            print("", file=out)
+            print("static char *_disassembly_%i /* %s */ (char *_out, DIS_OPS_T _operands)" % (idx, inst.ID), file=out)
+            print("{", file=out)
+            if len(conversions) == 0:
+                print("  (void)_operands;", file=out)
+            for (kind, value) in fields:
+                if kind == "literal":
+                    print("  _out = DIS_LITERAL(_out, %s, %i);" % (ENUM._c_string(value), len(value)), file=out)
+                elif kind == "u":
+                    print("  _out = DIS_UTOA(_out, _operands[%i]);" % value, file=out)
+                elif kind == "d":
+                    print("  _out = DIS_ITOA(_out, _operands[%i]);" % value, file=out)
+            print("  return _out;", file=out)
+            print("}", file=out)
+            idx += 1
+        print("", file=out)
+        print("#define DIS_MAX_LENGTH %i" % max_length, file=out)
+        print("typedef size_t (*DIS_LENGTH_FUNC_T)(DIS_OPS_T _operands);", file=out)
+        print("typedef char *(*DIS_FUNC_T)(char *_out, DIS_OPS_T _operands);", file=out)
+        print("static const DIS_LENGTH_FUNC_T _disassembly_lengths[] = {", file=out)
+        idx = 0
+        for inst in ENUM.instructions_list:
+            print("  _disassembly_length_%i /* %s */," % (idx, inst.ID), file=out)
+            idx += 1
+        print("};", file=out)
+        print("static const DIS_FUNC_T _disassemblies[] = {", file=out)
+        idx = 0
+        for inst in ENUM.instructions_list:
+            print("  _disassembly_%i /* %s */," % (idx, inst.ID), file=out)
+            idx += 1
+        print("};", file=out)
+
+execfile(sys.argv[1])
+ENUM.emit_disassembly(sys.argv[2])
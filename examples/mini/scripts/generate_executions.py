@@ -31,6 +31,7 @@
 
 from __future__ import print_function
 import sys
+import re
 
 class ENUM:
 
@@ -42,10 +43,55 @@ class ENUM:
         self.parsing = parsing
         self.encoding = encoding
         self.short_desc = short_desc
-        self.execution = execution
+        self.execution = ENUM._lower_stores(execution)
         self.description = description
         self.instructions_list.append(self)
         
+    @staticmethod
+    def instruction(ID):
+        for inst in ENUM.instructions_list:
+            if inst.ID == ID: return inst
+        assert False, "undefined instruction: %s" % ID
+
+    @staticmethod
+    def _lower_stores(execution):
+        """
+        Returns the execution with the memory stores MS32(addr) = value
+        rewritten as MW32(addr, value), memory being accessed through
+        functions and not lvalues.
+        """
+        lowered = ""
+        while True:
+            start = execution.find("MS32(")
+            if start < 0: break
+            depth = 0
+            for end in range(start + 4, len(execution)):
+                if execution[end] == "(": depth += 1
+                elif execution[end] == ")": depth -= 1
+                if depth == 0: break
+            addr = execution[start + 5:end]
+            match = re.match(r"\s*=(?!=)\s*", execution[end + 1:])
+            assert match, "unsupported memory store: %s" % execution
+            value_start = end + 1 + match.end()
+            value_end = value_start
+            depth = 0
+            while value_end < len(execution):
+                if execution[value_end] == "(": depth += 1
+                elif execution[value_end] == ")": depth -= 1
+                if depth < 0 or (depth == 0 and execution[value_end] == ";"): break
+                value_end += 1
+            lowered += "%sMW32(%s, %s)" % (execution[:start], addr, execution[value_start:value_end].rstrip())
+            execution = execution[value_end:]
+        return lowered + execution
+
+    @staticmethod
+    def accesses_mem(execution):
+        return re.search(r"M[RW]32\(", execution) is not None
+
+    @staticmethod
+    def sets_pc(inst):
+        return re.search(r"RS\(\s*PC\s*,", inst.execution) is not None
+
     @staticmethod
     def emit_execution(out):
         with open(out, "w") as outf:
@@ -53,6 +99,94 @@ class ENUM:
             ENUM._emit_executions(outf)
             print("/* END: Generated executions */", file=outf)
 
+    @staticmethod
+    def _inplace_hazards(execution):
+        """
+        Returns the register files read after being written by the
+        in-place execution, i.e. the ones for which a read must see
+        the value before the execution. The statements are scanned in
+        order, a statement reading its operands before its assignment.
+        Memory is accounted as the MEM pseudo register file.
+        """
+        written = set()
+        hazards = set()
+        for stmt in re.split(r"[;{}]", execution):
+            reads = set(re.findall(r"RR\(\s*(\w+)\s*,", stmt))
+            if re.search(r"MR32\(", stmt): reads.add("MEM")
+            writes = set(re.findall(r"RS\(\s*(\w+)\s*,", stmt))
+            if re.search(r"MW32\(", stmt): writes.add("MEM")
+            hazards |= reads & written
+            written |= writes
+        return hazards
+
+    @staticmethod
+    def _inplace_writes(execution):
+        """
+        Returns the (register file, index) pairs written by the
+        execution, in order and without duplicates. Indexes must be
+        constants or operands, i.e. known before the execution.
+        """
+        writes = []
+        for (rf, reg) in re.findall(r"RS\(\s*(\w+)\s*,\s*([^()]*(?:\([^()]*\))?)\s*\)", execution):
+            assert re.match(r"^(\d+|P\(\d+\))$", reg), "unsupported register index %s" % reg
+            if (rf, reg) not in writes: writes.append((rf, reg))
+        return writes
+
+    @staticmethod
+    def _emit_execution_transactional(out, idx, inst):
+        print("", file=out)
+        print("static int32_t _execution_%i /* %s */ (EXE_CTX_T _context, EXE_OPS_T _operands, size_t _op_size)" %
+              (idx, inst.ID), file=out)
+        print("{", file=out)
+        print("  CPU_T _cpu, *_cpu_prev = EXE_CTX_CPU(_context);", file=out)
+        print("  MEM_T _mem, *_mem_prev = EXE_CTX_MEM(_context);", file=out)
+        print("  EXE_CPU_CLONE(_cpu, _cpu_prev);", file=out)
+        print("  EXE_MEM_CLONE(_mem, _mem_prev);", file=out)
+        print("  RS(PC,0) = NEXT_PC();", file=out)
+        print("  %s;" % inst.execution, file=out)
+        if ENUM.accesses_mem(inst.execution):
+            print("  if (EXE_MEM_STATUS(_mem) != 0) return -1;", file=out)
+        print("  EXE_CPU_UPDATE(*_cpu_prev, &_cpu);", file=out);
+        print("  EXE_CPU_UPDATE(*_mem_prev, &_mem);", file=out);
+        print("  return 0;", file=out)
+        print("}", file=out);
+
+    @staticmethod
+    def _emit_execution_inplace(out, idx, inst):
+        execution = inst.execution.replace("NEXT_PC()", "(RR(PC,0) + _op_size)")
+        hazards = ENUM._inplace_hazards("RS(PC,0) = RR(PC,0);\n%s" % execution)
+        print("", file=out)
+        if "MEM" in hazards:
+            # Memory can not be snapshot, fallback to the transactional execution.
+            print("#define _execution_inplace_%i _execution_%i /* %s */" % (idx, idx, inst.ID), file=out)
+            return
+        for rf in sorted(hazards):
+            execution = re.sub(r"RR\(\s*%s\s*," % rf, "RRS(%s," % rf, execution)
+        print("static int32_t _execution_inplace_%i /* %s */ (EXE_CTX_T _context, EXE_OPS_T _operands, size_t _op_size)" %
+              (idx, inst.ID), file=out)
+        print("{", file=out)
+        print("  CPU_T *_cpu = EXE_CTX_CPU(_context);", file=out)
+        if ENUM.accesses_mem(execution):
+            print("  MEM_T _mem = *EXE_CTX_MEM(_context);", file=out)
+        for rf in sorted(hazards):
+            print("  EXE_CPU_SNAPSHOT(_cpu, %s);" % rf, file=out)
+        # A memory fault leaves the state as before, as for the transactional execution.
+        saved = []
+        if ENUM.accesses_mem(execution):
+            saved = ENUM._inplace_writes("RS(PC,0) = NEXT_PC();\n%s" % execution)
+            for (i, (rf, reg)) in enumerate(saved):
+                print("  uint32_t _saved_%i = RR(%s,%s);" % (i, rf, reg), file=out)
+        print("  RS(PC,0) = NEXT_PC();", file=out)
+        print("  %s;" % execution, file=out)
+        if ENUM.accesses_mem(execution):
+            print("  if (EXE_MEM_STATUS(_mem) != 0) {", file=out)
+            for (i, (rf, reg)) in reversed(list(enumerate(saved))):
+                print("    RS(%s,%s) = _saved_%i;" % (rf, reg, i), file=out)
+            print("    return -1;", file=out)
+            print("  }", file=out)
+        print("  return 0;", file=out)
+        print("}", file=out);
+
     @staticmethod
     def _emit_executions(out):
         idx = 0;
@@ -61,22 +195,21 @@ class ENUM:
         print("#define RR(rf,idx) EXE_CPU_RR((*_cpu_prev),rf,idx)", file=out)
         print("#define RS(rf,idx) EXE_CPU_RS(_cpu,rf,idx)", file=out)
         print("#define MR32(idx) EXE_MEM_FETCH32(_mem,idx)", file=out)
-        print("#define MS32(idx) EXE_MEM_SLICE32(_mem,idx)", file=out)
+        print("#define MW32(idx,value) EXE_MEM_STORE32(_mem,idx,value)", file=out)
+        for inst in ENUM.instructions_list:
+            ENUM._emit_execution_transactional(out, idx, inst)
+            idx += 1
+        # In-place executions update only the touched state of the context,
+        # reads of a register file after its update use a snapshot.
+        print("", file=out)
+        print("#undef RR", file=out)
+        print("#undef RS", file=out)
+        print("#define RR(rf,idx) EXE_CPU_RR((*_cpu),rf,idx)", file=out)
+        print("#define RS(rf,idx) EXE_CPU_RS((*_cpu),rf,idx)", file=out)
+        print("#define RRS(rf,idx) EXE_SNAPSHOT_RR(rf,idx)", file=out)
+        idx = 0
         for inst in ENUM.instructions_list:
-            print("", file=out)
-            print("static int32_t _execution_%i /* %s */ (EXE_CTX_T _context, EXE_OPS_T _operands, size_t _op_size)" %
-                  (idx, inst.ID), file=out)
-            print("{", file=out)
-            print("  CPU_T _cpu, *_cpu_prev = EXE_CTX_CPU(_context);", file=out)
-            print("  MEM_T _mem, *_mem_prev = EXE_CTX_MEM(_context);", file=out)
-            print("  EXE_CPU_CLONE(_cpu, _cpu_prev);", file=out)
-            print("  EXE_MEM_CLONE(_mem, _mem_prev);", file=out)
-            print("  RS(PC,0) = NEXT_PC();", file=out)
-            print("  %s;" % inst.execution, file=out)
-            print("  EXE_CPU_UPDATE(*_cpu_prev, &_cpu);", file=out);
-            print("  EXE_CPU_UPDATE(*_mem_prev, &_mem);", file=out);
-            print("  return 0;", file=out)
-            print("}", file=out);
+            ENUM._emit_execution_inplace(out, idx, inst)
             idx += 1
         print("#undef RF", file=out)
         print("#undef MEM", file=out)
@@ -87,6 +220,92 @@ class ENUM:
             print("  _execution_%i /* %s */," % (idx, inst.ID), file=out)
             idx += 1
         print("};", file=out)
+        print("static const EXE_FUNC_T _executions_inplace[] = {", file=out)
+        idx = 0
+        for inst in ENUM.instructions_list:
+            print("  _execution_inplace_%i /* %s */," % (idx, inst.ID), file=out)
+            idx += 1
+        print("};", file=out)
+        # Opcodes and operations setting the PC, for code translators.
+        print("static const uint8_t _executions_control[] = {", file=out)
+        for inst in ENUM.instructions_list:
+            print("  %i /* %s */," % (ENUM.sets_pc(inst), inst.ID), file=out)
+        print("};", file=out)
+        idx = 0
+        for inst in ENUM.instructions_list:
+            print("#define EXE_OPCODE_%s %i" % (inst.ID.split(":")[-1], idx), file=out)
+            idx += 1
+        print("#define EXE_FOREACH_EXECUTION(X) \\", file=out)
+        idx = 0
+        for inst in ENUM.instructions_list:
+            print("  X(%i) /* %s */ \\" % (idx, inst.ID), file=out)
+            idx += 1
+        print("  /* END: EXE_FOREACH_EXECUTION */", file=out)
+        SUPER.emit_supers(out)
+
+class SUPER:
+    """
+    A superinstruction is a sequence of instructions executed as one
+    threaded code step. All the instructions but the last must fall
+    through, i.e. not set the PC.
+    """
+
+    supers_list = []
+    def __init__(self, *args):
+        self.IDs = args[:-1]
+        self.description = args[-1]
+        self.instructions = [ENUM.instruction(ID) for ID in self.IDs]
+        assert len(self.instructions) >= 2, "superinstruction of less than 2 instructions"
+        for inst in self.instructions[:-1]:
+            assert not ENUM.sets_pc(inst), \
+                "superinstruction with non fall through %s" % inst.ID
+        self.supers_list.append(self)
+
+    @staticmethod
+    def _emit_super(out, idx, sup, prefix):
+        print("", file=out)
+        print("static int32_t %s_super_%i /* %s */ (EXE_CTX_T _context, EXE_SOPS_T _ops, uint32_t *_count)" %
+              (prefix, idx, "+".join(sup.IDs)), file=out)
+        print("{", file=out)
+        print("  int32_t _res;", file=out)
+        # The executed count includes a failing operation, as for single steps.
+        for (i, inst) in enumerate(sup.instructions):
+            call = "%s_%i(_context, EXE_SOPS(_ops,%i), EXE_SOPS_SIZE(_ops,%i))" % (
+                prefix, ENUM.instructions_list.index(inst), i, i)
+            if i < len(sup.instructions) - 1:
+                print("  if ((_res = %s) != 0) { *_count = %i; return _res; }" % (call, i + 1), file=out)
+            else:
+                print("  *_count = %i;" % len(sup.instructions), file=out)
+                print("  return %s;" % call, file=out)
+        print("}", file=out)
+
+    @staticmethod
+    def emit_supers(out):
+        # Longest superinstructions first, such that the first match is the longest.
+        supers = sorted(SUPER.supers_list, key=lambda sup: -len(sup.instructions))
+        length_max = max([len(sup.instructions) for sup in supers] + [1])
+        for (idx, sup) in enumerate(supers):
+            SUPER._emit_super(out, idx, sup, "_execution")
+            SUPER._emit_super(out, idx, sup, "_execution_inplace")
+        print("", file=out)
+        print("#define EXE_SUPERS_COUNT %i" % len(supers), file=out)
+        print("#define EXE_SUPER_LENGTH_MAX %i" % length_max, file=out)
+        print("static const uint32_t _supers[][EXE_SUPER_LENGTH_MAX + 1] = {", file=out)
+        for (idx, sup) in enumerate(supers):
+            print("  { %i, %s } /* %s */," % (len(sup.instructions),
+                                             ", ".join([str(ENUM.instructions_list.index(inst))
+                                                        for inst in sup.instructions] +
+                                                       ["0"] * (length_max - len(sup.instructions))),
+                                             "+".join(sup.IDs)), file=out)
+        if not supers:
+            print("  { 0 }", file=out)
+        print("};", file=out)
+        print("#define EXE_FOREACH_SUPER(X) \\", file=out)
+        for (idx, sup) in enumerate(supers):
+            print("  X(%i, %i) /* %s */ \\" % (idx, len(sup.instructions), "+".join(sup.IDs)), file=out)
+        print("  /* END: EXE_FOREACH_SUPER */", file=out)
 
 execfile(sys.argv[1])
+if len(sys.argv) > 3:
+    execfile(sys.argv[3])
 ENUM.emit_execution(sys.argv[2])
@@ -0,0 +1,212 @@
+#!/usr/bin/env python
+#
+# Machine Description Interface C API
+#
+# This software is delivered under the terms of the MIT License
+#
+# Copyright (c) 2016 STMicroelectronics
+#
+# Permission is hereby granted, free of charge, to any person
+# obtaining a copy of this software and associated documentation
+# files (the "Software"), to deal in the Software without
+# restriction, including without limitation the rights to use,
+# copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following
+# conditions:
+#
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+# OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+# NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+# HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+# WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+# OTHER DEALINGS IN THE SOFTWARE.
+#
+#
+#
+# Translates ahead of time a MINI program into a C program simulating
+# it, which reports the same PC, instructions count and ret0 as
+# mdi-execute.
+#
+# Usage: translate_program.py instructions.enum text|binary input output.c
+#
+# Each operation is a labeled block executing the instruction
+# semantics through the RR/RS/MR32/MS32 macros, with PC reads
+# replaced by the operation constant PC. PC relative branches are
+# lowered to gotos, other PC updates dispatch on the new PC.
+# Branch targets must be operation starts.
+#
+
+from __future__ import print_function
+import os
+import sys
+import re
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import convert_encoding
+from convert_encoding import ConvertError, u32
+
+# Initial PC, also the stop PC as for mdi-execute.
+RESET_PC = 0
+
+def inplace_hazards(execution):
+    """
+    Returns the register files read after being written, see
+    generate_executions.py.
+    """
+    written = set()
+    hazards = set()
+    for stmt in re.split(r"[;{}]", execution):
+        reads = set(re.findall(r"RR\(\s*(\w+)\s*,", stmt))
+        if re.search(r"MR32\(", stmt): reads.add("MEM")
+        writes = set(re.findall(r"RS\(\s*(\w+)\s*,", stmt))
+        if re.search(r"MS32\(", stmt): writes.add("MEM")
+        hazards |= reads & written
+        written |= writes
+    return hazards
+
+def goto(pc, target, offsets, labels):
+    """
+    Returns the jump from the operation at pc to target, checking
+    stop conditions in mdi-execute order. Adds the label used to
+    labels.
+    """
+    if target == pc: label = "stop_loop"
+    elif target == RESET_PC: label = "stop_pc"
+    elif target in offsets: label = "L_%d" % target
+    else: label = "dispatch"
+    labels.add(label)
+    return "goto %s;" % label
+
+def translate_operation(out, pc, size, inst, operands, offsets, labels):
+    execution = inst.execution
+    # PC relative branches ending the execution are lowered to gotos.
+    def branch(match):
+        if not re.match(r"^[\s;}]*$", execution[match.end():]): return match.group(0)
+        target = u32(pc + operands[int(match.group(1))])
+        return "{ _pc = %du; %s }" % (target, goto(pc, target, offsets, labels))
+    execution = re.sub(r"RS\(\s*PC\s*,\s*0\s*\)\s*=\s*RR\(\s*PC\s*,\s*0\s*\)\s*\+\s*P\((\d+)\)", branch, execution)
+    dynamic = re.search(r"RS\(\s*PC\s*,", execution) is not None
+    execution = execution.replace("NEXT_PC()", "%du" % u32(pc + size))
+    execution = re.sub(r"RR\(\s*PC\s*,\s*0\s*\)", "%du" % pc, execution)
+    execution = re.sub(r"RS\(\s*PC\s*,\s*0\s*\)", "_pc", execution)
+    execution = re.sub(r"\bP\((\d+)\)", lambda m: "%du" % operands[int(m.group(1))], execution)
+    hazards = inplace_hazards(execution)
+    if "MEM" in hazards:
+        raise ConvertError("memory read after write in %s not supported" % inst.ID)
+    for rf in sorted(hazards):
+        execution = re.sub(r"RR\(\s*%s\s*," % rf, "RRS(%s," % rf, execution)
+
+    print("", file=out)
+    print(" L_%d: /* %s */" % (pc, inst.ID), file=out)
+    print("    count++;", file=out)
+    print("    _pc = %du;" % u32(pc + size), file=out)
+    print("    {", file=out)
+    for rf in sorted(hazards):
+        print("        SNAPSHOT(%s);" % rf, file=out)
+    print("        %s;" % execution.replace("\n", "\n        "), file=out)
+    print("    }", file=out)
+    if dynamic:
+        labels.update(["stop_loop", "dispatch"])
+        print("    if (_pc == %du) goto stop_loop;" % pc, file=out)
+        print("    goto dispatch;", file=out)
+    else:
+        print("    %s" % goto(pc, u32(pc + size), offsets, labels), file=out)
+
+def translate(out, operations, end, input_name):
+    offsets = set([offset for (offset, inst, operands) in operations])
+    labels = set()
+    sizes = [next_offset - offset for (offset, next_offset) in
+             zip([op[0] for op in operations], [op[0] for op in operations[1:]] + [end])]
+    print("/* Generated by translate_program.py from %s */" % input_name, file=out)
+    print("#include <stdint.h>", file=out)
+    print("#include <stdio.h>", file=out)
+    print("#include <string.h>", file=out)
+    print("#include <inttypes.h>", file=out)
+    print("", file=out)
+    print("#ifndef MEM_BYTES", file=out)
+    print("#define MEM_BYTES 4096", file=out)
+    print("#endif", file=out)
+    print("", file=out)
+    print("static struct {", file=out)
+    print("    uint32_t R32[32];", file=out)
+    print("    uint32_t PC[1];", file=out)
+    print("    uint32_t SAVE[6];", file=out)
+    print("    uint32_t STAT[1];", file=out)
+    print("    uint32_t TRAP[16];", file=out)
+    print("} cpu;", file=out)
+    if [op for op in operations if re.search(r"M[RS]32\(", op[1].execution)]:
+        print("static uint32_t mem_words[MEM_BYTES / sizeof(uint32_t)];", file=out)
+    print("", file=out)
+    print("#define RR(rf,idx) ((uint32_t)cpu.rf[idx])", file=out)
+    print("#define RS(rf,idx) cpu.rf[idx]", file=out)
+    print("#define RRS(rf,idx) ((uint32_t)_snapshot_##rf[idx])", file=out)
+    print("#define SNAPSHOT(rf) uint32_t _snapshot_##rf[sizeof(cpu.rf) / sizeof(cpu.rf[0])]; \\", file=out)
+    print("    memcpy(_snapshot_##rf, cpu.rf, sizeof(_snapshot_##rf))", file=out)
+    print("#define MR32(idx) (*(uint32_t *)(&((char *)mem_words)[idx]))", file=out)
+    print("#define MS32(idx) (*(uint32_t *)(&((char *)mem_words)[idx]))", file=out)
+    print("", file=out)
+    print("int main(void)", file=out)
+    print("{", file=out)
+    print("    uint64_t count = 0;", file=out)
+    print("    uint32_t _pc = %du;" % RESET_PC, file=out)
+    print("", file=out)
+    print("    fprintf(stdout, \"Start of execution at PC: %\"PRIu32\"\\n\", _pc);", file=out)
+    print("    goto lookup;", file=out)
+    for ((offset, inst, operands), size) in zip(operations, sizes):
+        translate_operation(out, offset, size, inst, operands, offsets, labels)
+    print("", file=out)
+    if "dispatch" in labels:
+        labels.add("stop_pc")
+        print(" dispatch:", file=out)
+        print("    if (_pc == %du) goto stop_pc;" % RESET_PC, file=out)
+    print(" lookup:", file=out)
+    print("    switch (_pc) {", file=out)
+    for offset in sorted(offsets):
+        print("    case %du: goto L_%d;" % (offset, offset), file=out)
+    print("    }", file=out)
+    print("    fprintf(stderr, \"%%s: invalid operation decode at PC: %%\"PRIu32\"\\n\", \"%s\", _pc);" %
+          input_name.replace("\\", "\\\\").replace("\"", "\\\""), file=out)
+    print("    return 1;", file=out)
+    if "stop_loop" in labels:
+        print(" stop_loop:", file=out)
+        print("    fprintf(stdout, \"processor PC busy loop, assuming stopped at PC: %\"PRIu32\"\\n\", _pc);", file=out)
+        print("    goto end;", file=out)
+    if "stop_pc" in labels:
+        print(" stop_pc:", file=out)
+        print("    fprintf(stdout, \"processor PC stop value, assuming reset at PC: %\"PRIu32\"\\n\", _pc);", file=out)
+        print("    goto end;", file=out)
+    print(" end:", file=out)
+    print("    cpu.PC[0] = _pc;", file=out)
+    print("    fprintf(stdout, \"End of execution at PC: %\"PRIu32\"\\n\", cpu.PC[0]);", file=out)
+    print("    fprintf(stdout, \"  Insrructions count: %\"PRIu64\"\\n\", count);", file=out)
+    print("    fprintf(stdout, \"  Return value ret0: %\"PRIu64\"\\n\", (uint64_t)cpu.R32[0]);", file=out)
+    print("    return 0;", file=out)
+    print("}", file=out)
+
+def main(args):
+    if len(args) != 4 or args[1] not in ("text", "binary"):
+        print("usage: translate_program.py instructions.enum text|binary input output.c", file=sys.stderr)
+        return 2
+    exec(open(args[0]).read(), convert_encoding.__dict__)
+    with open(args[2], "rb") as inf:
+        data = inf.read()
+    try:
+        if args[1] == "text":
+            operations, end = convert_encoding.parse_text(data.decode("ascii"))
+        else:
+            operations, end = convert_encoding.parse_binary(data)
+        with open(args[3], "w") as outf:
+            translate(outf, operations, end, args[2])
+    except ConvertError as e:
+        print("translate_program.py: error: %s: %s" % (args[2], e), file=sys.stderr)
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -39,7 +39,7 @@
 /*
  * The implemented MDI revision.
  */
-#define THIS_REVISION MDI_VERSION_MAKE_REV(0,2,0)
+#define THIS_REVISION MDI_VERSION_MAKE_REV(0,3,0)
 static const int mdi_revision = THIS_REVISION;
 
 #if THIS_REVISION != MDI_VERSION_REV
@@ -0,0 +1,180 @@
+/*
+ * Decode Cache Interface Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+
+#define UNUSED(var) ((void)(var))
+
+#define ENTRIES_DEFAULT 4096
+
+/*
+ * Direct mapped cache indexed by the decode offset. Each entry
+ * owns a storage slot where the operation is decoded in place.
+ */
+typedef struct {
+    MDI_ptr_t buffer;
+    MDI_size_t offset;
+    MDI_size_t size;
+    MDI_Operation_t operation;
+} cache_entry_t;
+
+typedef struct {
+    MDI_Decoder_t decoder;
+    cache_entry_t *entries;
+    size_t entries_mask;
+    char *storage;
+    MDI_size_t storage_size;
+} decode_cache_t;
+
+MDI_res_t MDI_DecodeCache_init(MDI_DecodeCache_t *self_ref, MDI_Decoder_t decoder, MDI_size_t entries, MDI_object_t params)
+{
+    decode_cache_t *cache;
+    size_t count, align;
+
+    assert(self_ref != NULL);
+    assert(decoder != NULL);
+    assert(entries >= 0);
+    UNUSED(params);
+
+    if (entries == 0) entries = ENTRIES_DEFAULT;
+    count = 1;
+    while (count < entries)
+        count <<= 1;
+
+    cache = (decode_cache_t *)calloc(1, sizeof(decode_cache_t));
+    if (cache == NULL) return -1;
+    cache->decoder = decoder;
+    cache->entries_mask = count - 1;
+
+    /* Round storage slots to the storage alignment, malloc() storage is suitably aligned. */
+    align = MDI_Operation_storage_align();
+    cache->storage_size = (MDI_Decoder_storage_size(decoder) + align - 1) & ~(align - 1);
+    cache->entries = (cache_entry_t *)calloc(count, sizeof(cache_entry_t));
+    cache->storage = (char *)malloc(count * cache->storage_size);
+    if (cache->entries == NULL || cache->storage == NULL) {
+        free(cache->entries);
+        free(cache->storage);
+        free(cache);
+        return -1;
+    }
+
+    *self_ref = (MDI_DecodeCache_t)cache;
+    return 0;
+}
+
+static void entry_drop(cache_entry_t *entry)
+{
+    MDI_DecodeInfo_t decode_info;
+
+    if (entry->operation == NULL) return;
+    decode_info = MDI_Operation_decode_info(entry->operation);
+    if (decode_info != NULL) MDI_DecodeInfo_fini(&decode_info);
+    MDI_Operation_fini(&entry->operation);
+    entry->operation = NULL;
+}
+
+MDI_res_t MDI_DecodeCache_fini(MDI_DecodeCache_t *self_ref)
+{
+    decode_cache_t *cache;
+    size_t i;
+
+    assert(self_ref != NULL);
+    cache = (decode_cache_t *)*self_ref;
+    if (cache == NULL) return -1;
+
+    for (i = 0; i <= cache->entries_mask; i++) {
+        entry_drop(&cache->entries[i]);
+    }
+    free(cache->entries);
+    free(cache->storage);
+    free(cache);
+    *self_ref = NULL;
+    return 0;
+}
+
+MDI_Operation_t MDI_DecodeCache_decode(MDI_DecodeCache_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr)
+{
+    decode_cache_t *cache;
+    cache_entry_t *entry;
+    MDI_size_t offset;
+    MDI_ptr_t current;
+    size_t idx;
+
+    assert(self != NULL);
+    assert(buffer != NULL);
+    assert(current_ptr != NULL);
+    assert((const char *)*current_ptr >= (const char *)buffer && (const char *)*current_ptr < (const char *)buffer + buffer_size);
+
+    cache = (decode_cache_t *)self;
+    offset = (const char *)*current_ptr - (const char *)buffer;
+    idx = (size_t)offset & cache->entries_mask;
+    entry = &cache->entries[idx];
+
+    if (entry->operation != NULL && entry->buffer == buffer && entry->offset == offset &&
+        offset + entry->size <= buffer_size) {
+        *current_ptr = (const char *)buffer + offset + entry->size;
+        return entry->operation;
+    }
+
+    entry_drop(entry);
+    current = *current_ptr;
+    entry->operation = MDI_Decoder_decode_storage(cache->decoder,
+                                                  cache->storage + idx * cache->storage_size,
+                                                  cache->storage_size,
+                                                  buffer, buffer_size, &current);
+    if (entry->operation == NULL) return (MDI_Operation_t)NULL;
+    entry->buffer = buffer;
+    entry->offset = offset;
+    entry->size = (const char *)current - (const char *)*current_ptr;
+
+    *current_ptr = current;
+    return entry->operation;
+}
+
+void MDI_DecodeCache_invalidate(MDI_DecodeCache_t self, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size)
+{
+    decode_cache_t *cache;
+    cache_entry_t *entry;
+    size_t i;
+
+    assert(self != NULL);
+    cache = (decode_cache_t *)self;
+
+    for (i = 0; i <= cache->entries_mask; i++) {
+        entry = &cache->entries[i];
+        if (entry->operation != NULL && entry->buffer == buffer &&
+            entry->offset < offset + size && offset < entry->offset + entry->size)
+            entry_drop(entry);
+    }
+}
@@ -30,21 +30,74 @@
 
 #include <stdint.h>
 #include <stdlib.h>
-#include <stdio.h>
 #include <assert.h>
 #include <ctype.h>
 #include <string.h>
 #include <MDI/mdi.h>
 #include <MDI/mdi_operations.h>
+#include "mdi_params.h"
+#include "mdi_decoder.h"
 
-#define OPERANDS_MAX 4
+/*
+ * The decoder is generated from the machine description as a switch
+ * over the encoding prefix characters, each matched prefix being
+ * followed by the inlined parsers of its encoding fields.
+ * The generated _decode_operation() parses [current, limit[ which
+ * must end with the '.' terminator and returns the number of parsed
+ * operands, or -1 if the input does not match exactly an encoding.
+ * It supersedes the prefix hash table and the field programs which
+ * were built at Decoder construction: the switch is the prefix
+ * lookup and the inlined parsers are the field programs, both
+ * computed at build time, sharing decode_number() instead of sscanf().
+ * This implementation only manage 32 bits operands.
+ */
+static inline int decode_number(const char **current_ref, const char *limit, int is_signed, uint32_t *value_ref)
+{
+    const char *current = *current_ref;
+    uint32_t value, digit, max_value;
+    int negate = 0;
+
+    if (is_signed && current < limit && (*current == '-' || *current == '+')) {
+        negate = *current == '-';
+        current++;
+    }
+    if (current == limit || (unsigned)(*current - '0') > 9) return -1;
+    /* Out of range values are invalid, the magnitude of INT32_MIN being INT32_MAX + 1. */
+    max_value = !is_signed ? UINT32_MAX: negate ? (uint32_t)INT32_MAX + 1: (uint32_t)INT32_MAX;
+    value = 0;
+    while (current < limit && (digit = (uint32_t)(*current - '0')) <= 9) {
+        if (value > (max_value - digit) / 10) return -1;
+        value = value * 10 + digit;
+        current++;
+    }
+    *value_ref = negate ? -value: value;
+    *current_ref = current;
+    return 0;
+}
+
+#define DEC_LITERAL(c) if (_current == _limit || *_current != (c)) return -1; _current++
+#define DEC_SPACES() while (_current < _limit && isspace(*_current)) _current++
+#define DEC_UNSIGNED(idx) if (decode_number(&_current, _limit, 0, &_operands[idx]) != 0) return -1
+#define DEC_SIGNED(idx) if (decode_number(&_current, _limit, 1, &_operands[idx]) != 0) return -1
+#define DEC_END(operator_idx, opcount) \
+    if (_current != _limit) return -1; \
+    *_operator_ref = (operator_idx); \
+    return (opcount)
+
+#include "generated_decoder.inc"
+
+typedef char dec_operands_max_check[DEC_OPERANDS_MAX <= MINI_OPERANDS_MAX ? 1: -1];
 
 typedef struct {
     MDI_interface_t mdi;
     MDI_Processor_t processor;
+    MDI_size_t storage_size;
+    MDI_OperationPool_t pool;
+    MDI_size_t origin;
+    int binary;
+    mini_predecoded_t predecoded;
 } decoder_t;
 
-
 MDI_res_t MDI_Decoder_init(MDI_Decoder_t *self_ref, MDI_interface_t mdi, MDI_Processor_t processor, MDI_object_t params)
 {
     decoder_t *decoder;
@@ -54,7 +107,9 @@ MDI_res_t MDI_Decoder_init(MDI_Decoder_t *self_ref, MDI_interface_t mdi, MDI_Pro
     decoder = (decoder_t *)calloc(1, sizeof(decoder_t));
     decoder->mdi = mdi;
     decoder->processor = processor;
-    
+    decoder->storage_size = MDI_Operation_storage_size(DEC_OPERANDS_MAX);
+    decoder->binary = mini_params_is(params, "encoding", "binary");
+
     *self_ref = (MDI_Decoder_t)decoder;
     return 0;
 }
@@ -67,6 +122,7 @@ MDI_res_t MDI_Decoder_fini(MDI_Decoder_t *self_ref)
     decoder = (decoder_t *)*self_ref;
     if (decoder == NULL) return -1;
 
+    mini_predecoded_close(&decoder->predecoded);
     free(decoder);
     *self_ref = NULL;
 
@@ -74,98 +130,372 @@ MDI_res_t MDI_Decoder_fini(MDI_Decoder_t *self_ref)
 }
 
 
-MDI_Operation_t MDI_Decoder_decode(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr)
+void MDI_Decoder_set_pool(MDI_Decoder_t self, MDI_OperationPool_t pool)
 {
     decoder_t *decoder;
-    const char *start, *limit, *current;
-    const char *opcode, *opcode_end, *operator_end;
-    uint32_t decode_operands[OPERANDS_MAX];
-    intptr_t operation_operands[OPERANDS_MAX];
-    MDI_Operation_t operation;
-    MDI_Operator_t operator;
-    MDI_str_t encoding;
-    MDI_interface_t interface;
-    MDI_Processor_t processor;
-    MDI_DecodeInfo_t decode_info;
-    MDI_res_t res;
-    int num_operands;
-    int i;
 
     assert(self != NULL);
-    assert(buffer != NULL);
-    assert(current_ptr != NULL);
-    assert((const char *)*current_ptr >= (const char *)buffer && (const char *)*current_ptr < (const char *)buffer + buffer_size);
+    decoder = (decoder_t *)self;
+
+    decoder->pool = pool;
+}
+
+MDI_interface_t mini_decoder_interface(MDI_Decoder_t self)
+{
+    decoder_t *decoder;
 
+    assert(self != NULL);
     decoder = (decoder_t *)self;
-    interface = decoder->mdi;
-    processor = decoder->processor;
 
-    limit = (const char *)buffer + buffer_size;
-    start = (const char *)*current_ptr;
-    current = start;
+    return decoder->mdi;
+}
+
+MDI_size_t mini_decoder_fixed_size(MDI_Decoder_t self)
+{
+    decoder_t *decoder;
+
+    assert(self != NULL);
+    decoder = (decoder_t *)self;
+
+    return decoder->binary ? MINI_BINARY_SIZE: 0;
+}
+
+void MDI_Decoder_set_origin(MDI_Decoder_t self, MDI_size_t origin)
+{
+    decoder_t *decoder;
+
+    assert(self != NULL);
+    decoder = (decoder_t *)self;
+
+    decoder->origin = origin;
+}
+
+/*
+ * Parse one text encoded operation at *current_ref.
+ * Returns 0 and updates *current_ref past the trailing spaces on
+ * success, otherwise returns one of the MDI_DECODE_STOP_* reasons.
+ */
+static MDI_res_t parse_text(const char *limit, const char **current_ref, uint32_t *operands, uint32_t *operator_idx_ref, int *num_operands_ref)
+{
+    const char *current;
+    const char *opcode, *opcode_end;
+    int num_operands;
+
+    current = *current_ref;
 
     /* Skip leading spaces. */
     while(current < limit && isspace(*current))
         current++;
     opcode = current;
 
-    /* Count parameters and find end of opcode field. */
-    while (current < limit && *current != '.' && *current != '/') {
-        current++;
-    }
-    operator_end = current;
+    /* No more opcode. */
+    if (current == limit) return MDI_DECODE_STOP_END;
 
-    while (current < limit && *current != '.') {
-        current++;
-    }
-    opcode_end = current;
-
-    /* No opcode. */
-    if (current == limit) return (MDI_Operation_t)NULL;
-
-    /* Operator match for the given processor. Match done on Opcode. */
-    for (i = 0; i < MDI_Operators_count(interface); i++) {
-        operator = MDI_Operators_iter(interface, i);
-        encoding = MDI_Opcode_encoding(MDI_Operator_opcode(operator, processor));
-        if (strncmp(opcode, encoding, operator_end - opcode) == 0 &&
-            (encoding[operator_end - opcode] == '.' ||
-             encoding[operator_end - opcode] == '/'))
-            break;
-    }
+    /* Find end of opcode. */
+    opcode_end = (const char *)memchr(opcode, '.', limit - opcode);
 
-    /* No encoding match for the Operator. */
-    if (i == MDI_Operators_count(interface)) return (MDI_Operation_t)NULL;
-    
-    /* Parse operation operands. Assume a limit of 4 operands. */
-    /* This implementation only manage 32 bits operands. */
-    assert(OPERANDS_MAX == 4);
-    num_operands = sscanf(opcode, encoding,
-                          &decode_operands[0], &decode_operands[1],
-                          &decode_operands[2], &decode_operands[3]);
+    /* Truncated opcode. */
+    if (opcode_end == NULL) return MDI_DECODE_STOP_PARTIAL;
+
+    /* Operator match and operands parsing, including the terminating '.'. */
+    num_operands = _decode_operation(opcode, opcode_end + 1, operands, operator_idx_ref);
+    if (num_operands < 0) return MDI_DECODE_STOP_INVALID;
 
     /* Skip trailing spaces. */
     current = opcode_end + 1;
     while(current < limit && isspace(*current))
         current++;
 
+    *current_ref = current;
+    *num_operands_ref = num_operands;
+    return 0;
+}
+
+/*
+ * Parse one binary encoded operation at *current_ref, see the
+ * encoding description in mdi_decoder.h.
+ * Returns 0 and updates *current_ref on success, otherwise
+ * returns one of the MDI_DECODE_STOP_* reasons.
+ */
+static MDI_res_t parse_binary(const char *limit, const char **current_ref, uint32_t *operands, uint32_t *operator_idx_ref, int *num_operands_ref)
+{
+    const unsigned char *bytes;
+    uint32_t operator_idx;
+    int num_operands;
+    int i;
+
+    bytes = (const unsigned char *)*current_ref;
+
+    if ((const char *)bytes == limit) return MDI_DECODE_STOP_END;
+    if (limit - (const char *)bytes < MINI_BINARY_SIZE) return MDI_DECODE_STOP_PARTIAL;
+
+    if (bytes[0] == 0 || bytes[0] > DEC_OPERATORS_COUNT) return MDI_DECODE_STOP_INVALID;
+    operator_idx = bytes[0] - 1;
+    num_operands = _decode_opcounts[operator_idx];
+
+    for (i = 1; i < 4; i++) {
+        if (i < num_operands) operands[i - 1] = bytes[i];
+        else if (bytes[i] != 0) return MDI_DECODE_STOP_INVALID;
+    }
+    if (num_operands > 0) {
+        operands[num_operands - 1] = (uint32_t)bytes[4] | (uint32_t)bytes[5] << 8 |
+            (uint32_t)bytes[6] << 16 | (uint32_t)bytes[7] << 24;
+    } else if ((bytes[4] | bytes[5] | bytes[6] | bytes[7]) != 0) {
+        return MDI_DECODE_STOP_INVALID;
+    }
+
+    *current_ref = (const char *)bytes + MINI_BINARY_SIZE;
+    *operator_idx_ref = operator_idx;
+    *num_operands_ref = num_operands;
+    return 0;
+}
+
+/*
+ * Get one predecoded operation at *current_ref if the predecoded image
+ * of the decoder holds it and it ends before limit.
+ * Returns 0 and updates *current_ref on success, otherwise -1 and
+ * the operation must be parsed.
+ */
+static MDI_res_t parse_predecoded(mini_predecoded_t *image, MDI_ptr_t buffer, const char *limit, const char **current_ref, uint32_t *operands, uint32_t *operator_idx_ref, int *num_operands_ref)
+{
+    MDI_size_t idx;
+    uint32_t operator_idx;
+    int num_operands;
+    int i;
+
+    if (buffer != image->buffer) return -1;
+    idx = mini_predecoded_find(image, *current_ref - buffer);
+    if (idx < 0 || buffer + image->offsets[idx + 1] > limit) return -1;
+
+    operator_idx = image->operators[idx];
+    num_operands = image->opcounts[idx];
+    if (operator_idx >= DEC_OPERATORS_COUNT || num_operands != _decode_opcounts[operator_idx]) return -1;
+    for (i = 0; i < num_operands; i++)
+        operands[i] = image->operands[idx * image->stride + i];
+
+    *current_ref = buffer + image->offsets[idx + 1];
+    *operator_idx_ref = operator_idx;
+    *num_operands_ref = num_operands;
+    return 0;
+}
+
+/*
+ * Parse one operation at *current_ref with the decoder encoding.
+ * Returns 0 and updates *current_ref on success, otherwise
+ * returns one of the MDI_DECODE_STOP_* reasons.
+ */
+static inline MDI_res_t parse_operation(decoder_t *decoder, MDI_ptr_t buffer, const char *limit, const char **current_ref, uint32_t *operands, uint32_t *operator_idx_ref, int *num_operands_ref)
+{
+    if (decoder->predecoded.map != NULL &&
+        parse_predecoded(&decoder->predecoded, buffer, limit, current_ref, operands, operator_idx_ref, num_operands_ref) == 0)
+        return 0;
+    if (decoder->binary)
+        return parse_binary(limit, current_ref, operands, operator_idx_ref, num_operands_ref);
+    return parse_text(limit, current_ref, operands, operator_idx_ref, num_operands_ref);
+}
+
+MDI_res_t mini_decoder_parse(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ref, uint32_t *operands, uint32_t *operator_idx_ref, int *num_operands_ref)
+{
+    assert(self != NULL);
+    assert(buffer != NULL);
+    assert(current_ref != NULL);
+
+    return parse_operation((decoder_t *)self, buffer, buffer + buffer_size, current_ref,
+                           operands, operator_idx_ref, num_operands_ref);
+}
+
+/*
+ * Decode one operation at *current_ref, into storage if not NULL,
+ * otherwise from the decoder pool if any.
+ * Returns 0 and updates *current_ref on success, otherwise
+ * returns one of the MDI_DECODE_STOP_* reasons.
+ */
+static MDI_res_t decode_operation(decoder_t *decoder, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_ptr_t buffer, const char *limit, const char **current_ref, MDI_Operation_t *operation_ref)
+{
+    const char *start, *current;
+    uint32_t decode_operands[DEC_OPERANDS_MAX > 0 ? DEC_OPERANDS_MAX: 1];
+    intptr_t operation_operands[DEC_OPERANDS_MAX > 0 ? DEC_OPERANDS_MAX: 1];
+    MDI_Operation_t operation;
+    MDI_Operator_t operator;
+    uint32_t operator_idx;
+    MDI_res_t res;
+    int num_operands;
+    int i;
+
+    start = *current_ref;
+    current = start;
+
+    res = parse_operation(decoder, buffer, limit, &current, decode_operands, &operator_idx, &num_operands);
+    if (res != 0) return res;
+    operator = MDI_Operators_iter(decoder->mdi, operator_idx);
+
     for (i = 0; i < num_operands; i++) {
         operation_operands[i] = (intptr_t)decode_operands[i];
     }
 
-    res = MDI_DecodeInfo_init(&decode_info, buffer,
-                              start - buffer /* offset */,
-                              current - start /* opsize */,
-                              NULL);
-    if (res != 0) return (MDI_Operation_t)NULL;
+    if (storage != NULL) {
+        res = MDI_Operation_init_storage(&operation, storage, storage_size, operator,
+                                         num_operands, (MDI_ptr_t)operation_operands, NULL);
+    } else if (decoder->pool != NULL) {
+        res = MDI_Operation_init_pool(&operation, decoder->pool, operator,
+                                      num_operands, (MDI_ptr_t)operation_operands, NULL);
+    } else {
+        res = MDI_Operation_init(&operation, operator, num_operands, (MDI_ptr_t)operation_operands, NULL);
+    }
+    if (res != 0) return MDI_DECODE_STOP_ERROR;
 
-    res = MDI_Operation_init(&operation, operator, num_operands, (MDI_ptr_t)operation_operands, NULL);
+    /* The buffer is rebased by the origin for buffer + offset to still address the operation. */
+    res = MDI_Operation_init_decode_info(operation, (MDI_ptr_t)((uintptr_t)buffer - decoder->origin),
+                                         decoder->origin + (start - (const char *)buffer) /* offset */,
+                                         current - start /* opsize */,
+                                         NULL);
     if (res != 0) {
-        MDI_DecodeInfo_fini(&decode_info);
-        return (MDI_Operation_t)NULL;
+        MDI_Operation_fini(&operation);
+        return MDI_DECODE_STOP_ERROR;
     }
 
-    MDI_Operation_set_decode_info(operation, decode_info);
+    *current_ref = current;
+    *operation_ref = operation;
+    return 0;
+}
+
+MDI_Operation_t MDI_Decoder_decode(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr)
+{
+    decoder_t *decoder;
+    const char *current;
+    MDI_Operation_t operation;
+    MDI_res_t res;
+
+    assert(self != NULL);
+    assert(buffer != NULL);
+    assert(current_ptr != NULL);
+    assert((const char *)*current_ptr >= (const char *)buffer && (const char *)*current_ptr < (const char *)buffer + buffer_size);
+
+    decoder = (decoder_t *)self;
+    current = (const char *)*current_ptr;
+
+    res = decode_operation(decoder, NULL, 0, buffer, (const char *)buffer + buffer_size, &current, &operation);
+    if (res != 0) return (MDI_Operation_t)NULL;
+
+    *current_ptr = current;
+    return operation;
+}
+
+MDI_size_t MDI_Decoder_storage_size(MDI_Decoder_t self)
+{
+    decoder_t *decoder;
+
+    assert(self != NULL);
+    decoder = (decoder_t *)self;
+
+    return decoder->storage_size;
+}
+
+MDI_Operation_t MDI_Decoder_decode_storage(MDI_Decoder_t self, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr)
+{
+    decoder_t *decoder;
+    const char *current;
+    MDI_Operation_t operation;
+    MDI_res_t res;
+
+    assert(self != NULL);
+    assert(storage != NULL);
+    assert(buffer != NULL);
+    assert(current_ptr != NULL);
+    assert((const char *)*current_ptr >= (const char *)buffer && (const char *)*current_ptr < (const char *)buffer + buffer_size);
+
+    decoder = (decoder_t *)self;
+    current = (const char *)*current_ptr;
+
+    res = decode_operation(decoder, storage, storage_size, buffer, (const char *)buffer + buffer_size, &current, &operation);
+    if (res != 0) return (MDI_Operation_t)NULL;
 
     *current_ptr = current;
     return operation;
 }
+
+MDI_size_t MDI_Decoder_decode_batch(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr, MDI_Operation_t *operations, MDI_size_t max_count, MDI_res_t *stop_ref)
+{
+    decoder_t *decoder;
+    const char *current, *limit;
+    MDI_size_t count;
+    MDI_res_t res;
+
+    assert(self != NULL);
+    assert(buffer != NULL);
+    assert(current_ptr != NULL);
+    assert(operations != NULL || max_count == 0);
+    assert((const char *)*current_ptr >= (const char *)buffer && (const char *)*current_ptr <= (const char *)buffer + buffer_size);
+
+    decoder = (decoder_t *)self;
+    current = (const char *)*current_ptr;
+    limit = (const char *)buffer + buffer_size;
+
+    res = MDI_DECODE_STOP_COUNT;
+    for (count = 0; count < max_count; count++) {
+        res = decode_operation(decoder, NULL, 0, buffer, limit, &current, &operations[count]);
+        if (res != 0) break;
+    }
+    if (count == max_count) res = MDI_DECODE_STOP_COUNT;
+
+    *current_ptr = current;
+    if (stop_ref != NULL) *stop_ref = res;
+    return count;
+}
+
+MDI_res_t MDI_Decoder_predecode(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_str_t fname)
+{
+    decoder_t *decoder;
+
+    assert(self != NULL);
+    assert(buffer == NULL || fname != NULL);
+    decoder = (decoder_t *)self;
+
+    mini_predecoded_close(&decoder->predecoded);
+    if (buffer == NULL) return 0;
+    return mini_predecoded_open(&decoder->predecoded, self, decoder->mdi, buffer, buffer_size, fname);
+}
+
+/*
+ * Each text encoded Operation ends with a '.' which does not appear
+ * elsewhere in the encoding, the boundaries are then after a '.'
+ * and its following spaces, which belong to the preceding Operation.
+ * Binary encoded Operations are split at multiples of their size.
+ */
+MDI_size_t MDI_Decoder_split(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_size_t max_chunks, MDI_size_t *bounds)
+{
+    decoder_t *decoder;
+    const char *base, *limit, *current;
+    MDI_size_t count, target, i;
+
+    assert(self != NULL);
+    assert(buffer != NULL || buffer_size == 0);
+    assert(max_chunks >= 1);
+    assert(bounds != NULL);
+
+    decoder = (decoder_t *)self;
+    base = (const char *)buffer;
+    limit = base + buffer_size;
+    count = 0;
+    bounds[0] = 0;
+    for (i = 1; i < max_chunks; i++) {
+        target = buffer_size / max_chunks * i + buffer_size % max_chunks * i / max_chunks;
+        if (decoder->binary) {
+            target -= target % MINI_BINARY_SIZE;
+            if (target <= bounds[count]) continue;
+            if (target >= buffer_size) break;
+            bounds[++count] = target;
+            continue;
+        }
+        if (target <= bounds[count]) continue;
+        current = (const char *)memchr(base + target, '.', buffer_size - target);
+        if (current == NULL) break;
+        current++;
+        while (current < limit && isspace(*current))
+            current++;
+        if (current == limit) break;
+        bounds[++count] = current - base;
+    }
+    bounds[++count] = buffer_size;
+    return count;
+}
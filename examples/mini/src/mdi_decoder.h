@@ -0,0 +1,110 @@
+/*
+ * Decoder private interface for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef MDI_MINI_DECODER_H
+#define MDI_MINI_DECODER_H
+
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+
+/*
+ * The MINI Decoder supports the text encoding, and a fixed width
+ * binary encoding selected with the "encoding=binary" params.
+ * A binary encoded Operation is MINI_BINARY_SIZE bytes:
+ * - byte 0: the Operator index plus 1, 0 being invalid,
+ * - bytes 1 to 3: all operands but the last, as 8 bits unsigned values,
+ * - bytes 4 to 7: the last operand, as a 32 bits little endian value.
+ * Unused bytes are 0.
+ */
+#define MINI_BINARY_SIZE 8
+
+/*
+ * Maximal number of operands of the MINI Operators.
+ */
+#define MINI_OPERANDS_MAX 4
+
+/*
+ * Parses one Operation at *current_ref in [buffer, buffer + buffer_size[
+ * without constructing it, the operands array must hold
+ * MINI_OPERANDS_MAX values.
+ * Returns 0 and updates *current_ref on success, otherwise returns
+ * one of the MDI_DECODE_STOP_* reasons.
+ */
+extern MDI_res_t mini_decoder_parse(MDI_Decoder_t decoder, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ref, uint32_t *operands, uint32_t *operator_idx_ref, int *num_operands_ref);
+
+/*
+ * Returns the MDI interface of the decoder.
+ */
+extern MDI_interface_t mini_decoder_interface(MDI_Decoder_t decoder);
+
+/*
+ * Returns the size of all encoded Operations for a fixed width
+ * encoding, or 0 for a variable width encoding.
+ */
+extern MDI_size_t mini_decoder_fixed_size(MDI_Decoder_t decoder);
+
+/*
+ * Predecoded image of a code buffer, mapped from a predecoded file.
+ * It holds the Operations decoded sequentially from the buffer start,
+ * see mdi_decoder_predecode.c for the file layout.
+ */
+typedef struct {
+    MDI_ptr_t buffer;
+    MDI_size_t size;
+    void *map;
+    size_t map_size;
+    MDI_size_t count;
+    MDI_size_t stride;
+    const uint32_t *offsets;   /* count + 1 Operation start offsets, the last is the end offset. */
+    const uint16_t *operators; /* count Operator indexes. */
+    const uint8_t *opcounts;   /* count operands counts. */
+    const uint32_t *operands;  /* count * stride operands. */
+    MDI_size_t hint;
+} mini_predecoded_t;
+
+/*
+ * Maps fname into image if it is a predecoded file for the buffer
+ * content and the decoder, otherwise decodes the buffer with the
+ * decoder, which must not have a predecoded image, and writes fname.
+ * Returns 0 on success.
+ */
+extern MDI_res_t mini_predecoded_open(mini_predecoded_t *image, MDI_Decoder_t decoder, MDI_interface_t mdi, MDI_ptr_t buffer, MDI_size_t size, MDI_str_t fname);
+
+/*
+ * Unmaps image.
+ */
+extern void mini_predecoded_close(mini_predecoded_t *image);
+
+/*
+ * Returns the index of the Operation at offset in image, or -1.
+ */
+extern MDI_size_t mini_predecoded_find(mini_predecoded_t *image, MDI_size_t offset);
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Decoder Index Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+#include "mdi_decoder.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define INDEX_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Operation starts scan.
+ * An Operation starts at the buffer start, or after the '.' terminating
+ * the previous one and its trailing spaces, but only if there are
+ * non space characters to decode there.
+ * The scan state is kept across blocks: pending is set after a '.' until
+ * the next non space character, first is set until the first Operation.
+ */
+typedef struct {
+    uint32_t *offsets;
+    MDI_size_t max_count;
+    MDI_size_t count;
+    int pending;
+    int first;
+} index_state_t;
+
+#define INDEX_EMIT(state, offset)                                       \
+    do {                                                                \
+        if ((state)->count < (state)->max_count)                        \
+            (state)->offsets[(state)->count] = (uint32_t)(offset);      \
+        (state)->count++;                                               \
+    } while (0)
+
+/* isspace() in the C locale: ' ', '\t', '\n', '\v', '\f', '\r'. */
+#define INDEX_IS_SPACE(c) ((c) == ' ' || (unsigned char)((c) - '\t') <= '\r' - '\t')
+
+static void index_scalar(index_state_t *state, const unsigned char *base, size_t start, size_t end)
+{
+    size_t i;
+
+    for (i = start; i < end; i++) {
+        if (state->pending && !INDEX_IS_SPACE(base[i])) {
+            INDEX_EMIT(state, state->first ? 0: i);
+            state->pending = 0;
+            state->first = 0;
+        }
+        if (base[i] == '.') state->pending = 1;
+    }
+}
+
+/*
+ * Processes a block of width bytes given its '.' and non space
+ * characters bit masks.
+ */
+static inline void index_block(index_state_t *state, size_t block, unsigned width, uint64_t dots, uint64_t nonspaces)
+{
+    unsigned pos = 0;
+    uint64_t mask;
+
+    while (pos < width) {
+        if (state->pending) {
+            mask = nonspaces & (~(uint64_t)0 << pos);
+            if (mask == 0) break;
+            pos = __builtin_ctzll(mask);
+            INDEX_EMIT(state, state->first ? 0: block + pos);
+            state->pending = 0;
+            state->first = 0;
+        }
+        mask = dots & (~(uint64_t)0 << pos);
+        if (mask == 0) break;
+        pos = __builtin_ctzll(mask) + 1;
+        state->pending = 1;
+    }
+}
+
+#ifdef INDEX_X86
+static size_t index_sse2(index_state_t *state, const unsigned char *base, size_t size)
+{
+    const __m128i dot = _mm_set1_epi8('.');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i ctrl_max = _mm_set1_epi8('\r' - '\t');
+    __m128i v, ctrl;
+    uint64_t dots, spaces;
+    size_t i;
+
+    for (i = 0; i + 16 <= size; i += 16) {
+        v = _mm_loadu_si128((const __m128i *)(base + i));
+        dots = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, dot));
+        ctrl = _mm_sub_epi8(v, tab);
+        spaces = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                                          _mm_cmpeq_epi8(_mm_min_epu8(ctrl, ctrl_max), ctrl)));
+        if (dots == 0 && !state->pending) continue;
+        index_block(state, i, 16, dots, ~spaces & 0xffff);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t index_avx2(index_state_t *state, const unsigned char *base, size_t size)
+{
+    const __m256i dot = _mm256_set1_epi8('.');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i ctrl_max = _mm256_set1_epi8('\r' - '\t');
+    __m256i v, ctrl;
+    uint64_t dots, spaces;
+    size_t i;
+
+    for (i = 0; i + 32 <= size; i += 32) {
+        v = _mm256_loadu_si256((const __m256i *)(base + i));
+        dots = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, dot));
+        ctrl = _mm256_sub_epi8(v, tab);
+        spaces = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                                                                _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, ctrl_max), ctrl)));
+        if (dots == 0 && !state->pending) continue;
+        index_block(state, i, 32, dots, ~spaces & 0xffffffff);
+    }
+    return i;
+}
+#endif
+
+MDI_size_t MDI_Decoder_index(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, uint32_t *offsets, MDI_size_t max_count)
+{
+    index_state_t state;
+    const unsigned char *base;
+    MDI_size_t unit;
+    size_t done = 0;
+
+    assert(self != NULL);
+    assert(buffer != NULL || buffer_size == 0);
+    assert(offsets != NULL || max_count == 0);
+    assert((uint64_t)buffer_size <= UINT32_MAX);
+
+    base = (const unsigned char *)buffer;
+    state.offsets = offsets;
+    state.max_count = max_count;
+    state.count = 0;
+    state.pending = 1;
+    state.first = 1;
+
+    /* Fixed width Operations start at each multiple of their size. */
+    unit = mini_decoder_fixed_size(self);
+    if (unit != 0) {
+        for (done = 0; done < buffer_size; done += unit)
+            INDEX_EMIT(&state, done);
+        return state.count;
+    }
+
+#ifdef INDEX_X86
+    if (__builtin_cpu_supports("avx2"))
+        done = index_avx2(&state, base, buffer_size);
+    else
+        done = index_sse2(&state, base, buffer_size);
+#endif
+    index_scalar(&state, base, done, buffer_size);
+    return state.count;
+}
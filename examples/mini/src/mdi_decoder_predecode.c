@@ -0,0 +1,303 @@
+/*
+ * Decoder Predecoded Files Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+#include "mdi_decoder.h"
+
+/*
+ * A predecoded file is the header followed by the arrays:
+ * - uint32_t offsets[count + 1],
+ * - uint16_t operators[count],
+ * - uint8_t opcounts[count],
+ * - uint32_t operands[count * stride], 4 bytes aligned,
+ * in the host byte order. It is keyed by the buffer size and hash,
+ * the MDI revision and the decoder fixed size encoding, any other
+ * file is rewritten.
+ */
+#define PREDECODE_MAGIC "MDIPRED"
+#define PREDECODE_FORMAT 1
+
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    uint32_t revision;
+    uint64_t hash;
+    uint64_t buffer_size;
+    uint32_t fixed_size;
+    uint32_t stride;
+    uint64_t count;
+} predecode_header_t;
+
+#define ALIGN4(size) (((size) + 3) & ~(size_t)3)
+
+static size_t predecode_file_size(uint64_t count, uint64_t stride)
+{
+    return sizeof(predecode_header_t) + ALIGN4((count + 1) * 4 + count * 2 + count) + count * stride * 4;
+}
+
+/*
+ * Buffer content hash, FNV-1a on 64 bits words with a final
+ * mixing of the high bits, it is not a cryptographic hash.
+ */
+static uint64_t predecode_hash(const unsigned char *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL, word;
+    size_t i;
+
+    for (i = 0; i + 8 <= size; i += 8) {
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++)
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    return hash ^ (uint64_t)size;
+}
+
+static void predecode_key(predecode_header_t *header, MDI_Decoder_t decoder, MDI_interface_t mdi, MDI_ptr_t buffer, MDI_size_t size)
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, PREDECODE_MAGIC, sizeof(PREDECODE_MAGIC));
+    header->format = PREDECODE_FORMAT;
+    header->revision = MDI_interface_revision(mdi);
+    header->hash = predecode_hash((const unsigned char *)buffer, (size_t)size);
+    header->buffer_size = (uint64_t)size;
+    header->fixed_size = (uint32_t)mini_decoder_fixed_size(decoder);
+}
+
+/*
+ * Maps fname if it matches the key, returns 0 on success.
+ */
+static MDI_res_t predecode_map(mini_predecoded_t *image, const predecode_header_t *key, MDI_str_t fname)
+{
+    const predecode_header_t *header;
+    const char *base;
+    struct stat st;
+    void *map;
+    int fd;
+
+    fd = open(fname, O_RDONLY);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(predecode_header_t)) {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    header = (const predecode_header_t *)map;
+    if (memcmp(header->magic, key->magic, sizeof(header->magic)) != 0 ||
+        header->format != key->format || header->revision != key->revision ||
+        header->hash != key->hash || header->buffer_size != key->buffer_size ||
+        header->fixed_size != key->fixed_size ||
+        header->count > key->buffer_size || header->stride > 255 ||
+        predecode_file_size(header->count, header->stride) != (size_t)st.st_size) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    base = (const char *)map + sizeof(predecode_header_t);
+    image->map = map;
+    image->map_size = (size_t)st.st_size;
+    image->count = (MDI_size_t)header->count;
+    image->stride = (MDI_size_t)header->stride;
+    image->offsets = (const uint32_t *)base;
+    image->operators = (const uint16_t *)(image->offsets + image->count + 1);
+    image->opcounts = (const uint8_t *)(image->operators + image->count);
+    image->operands = (const uint32_t *)(base + ALIGN4((header->count + 1) * 4 + header->count * 2 + header->count));
+    image->hint = 0;
+    if (image->offsets[image->count] > header->buffer_size) {
+        munmap(map, (size_t)st.st_size);
+        image->map = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Decodes the buffer sequentially from its start and writes fname
+ * through a temporary file, returns 0 on success.
+ */
+static MDI_res_t predecode_write(predecode_header_t *key, MDI_Decoder_t decoder, MDI_ptr_t buffer, MDI_size_t size, MDI_str_t fname)
+{
+    MDI_res_t res = -1;
+    MDI_Operation_t operation;
+    MDI_ptr_t current;
+    MDI_ptr_mut_t storage = NULL;
+    MDI_size_t storage_size, opcount, i;
+    uint32_t *offsets = NULL, *operands = NULL;
+    uint16_t *operators = NULL;
+    uint8_t *opcounts = NULL;
+    size_t count = 0, alloc = 0, stride = 0, j;
+    char *tmp_fname = NULL;
+    FILE *output = NULL;
+    void *new_array;
+
+    storage_size = MDI_Decoder_storage_size(decoder);
+    storage = (MDI_ptr_mut_t)malloc(storage_size);
+    if (storage == NULL) goto end;
+
+    /*
+     * Operands are stored with the MINI maximal count, the storage size
+     * does not tell it as operands may be held inline.
+     */
+    stride = MINI_OPERANDS_MAX;
+    current = buffer;
+    while (current < buffer + size) {
+        MDI_ptr_t start = current;
+        operation = MDI_Decoder_decode_storage(decoder, storage, storage_size, buffer, size, &current);
+        if (operation == NULL) break;
+        if (count + 1 >= alloc) {
+            alloc = alloc == 0 ? 1024: alloc * 2;
+            if ((new_array = realloc(offsets, (alloc + 1) * sizeof(*offsets))) == NULL) goto end;
+            offsets = (uint32_t *)new_array;
+            if ((new_array = realloc(operators, alloc * sizeof(*operators))) == NULL) goto end;
+            operators = (uint16_t *)new_array;
+            if ((new_array = realloc(opcounts, alloc * sizeof(*opcounts))) == NULL) goto end;
+            opcounts = (uint8_t *)new_array;
+            if ((new_array = realloc(operands, alloc * stride * sizeof(*operands) + 1)) == NULL) goto end;
+            operands = (uint32_t *)new_array;
+        }
+        opcount = MDI_Operation_opcount(operation);
+        if (opcount > (MDI_size_t)stride) goto end;
+        offsets[count] = (uint32_t)(start - buffer);
+        operators[count] = (uint16_t)MDI_Operator_idx(MDI_Operation_operator(operation));
+        opcounts[count] = (uint8_t)opcount;
+        for (i = 0; i < opcount; i++)
+            operands[count * stride + i] = (uint32_t)((const intptr_t *)MDI_Operation_operands(operation))[i];
+        for (; i < (MDI_size_t)stride; i++)
+            operands[count * stride + i] = 0;
+        MDI_Operation_fini(&operation);
+        count++;
+    }
+    if (count == 0) goto end;
+    offsets[count] = (uint32_t)(current - buffer);
+    key->stride = (uint32_t)stride;
+    key->count = (uint64_t)count;
+
+    tmp_fname = (char *)malloc(strlen(fname) + 32);
+    if (tmp_fname == NULL) goto end;
+    sprintf(tmp_fname, "%s.%ld.tmp", fname, (long)getpid());
+    output = fopen(tmp_fname, "wb");
+    if (output == NULL) goto end;
+    if (fwrite(key, sizeof(*key), 1, output) != 1 ||
+        fwrite(offsets, sizeof(*offsets), count + 1, output) != count + 1 ||
+        fwrite(operators, sizeof(*operators), count, output) != count ||
+        fwrite(opcounts, sizeof(*opcounts), count, output) != count)
+        goto end;
+    for (j = (count + 1) * 4 + count * 2 + count; j % 4 != 0; j++)
+        if (fputc(0, output) == EOF) goto end;
+    if (fwrite(operands, sizeof(*operands), count * stride, output) != count * stride)
+        goto end;
+    if (fclose(output) != 0) {
+        output = NULL;
+        goto end;
+    }
+    output = NULL;
+    if (rename(tmp_fname, fname) != 0) goto end;
+    res = 0;
+ end:
+    if (output != NULL) fclose(output);
+    if (res != 0 && tmp_fname != NULL) unlink(tmp_fname);
+    free(tmp_fname);
+    free(offsets);
+    free(operators);
+    free(opcounts);
+    free(operands);
+    free(storage);
+    return res;
+}
+
+MDI_res_t mini_predecoded_open(mini_predecoded_t *image, MDI_Decoder_t decoder, MDI_interface_t mdi, MDI_ptr_t buffer, MDI_size_t size, MDI_str_t fname)
+{
+    predecode_header_t key;
+
+    assert(image != NULL);
+    assert(decoder != NULL);
+    assert(buffer != NULL);
+    assert(fname != NULL);
+
+    memset(image, 0, sizeof(*image));
+    if (size <= 0 || (uint64_t)size > UINT32_MAX) return -1;
+
+    predecode_key(&key, decoder, mdi, buffer, size);
+    if (predecode_map(image, &key, fname) != 0) {
+        if (predecode_write(&key, decoder, buffer, size, fname) != 0) return -1;
+        if (predecode_map(image, &key, fname) != 0) return -1;
+    }
+    image->buffer = buffer;
+    image->size = size;
+    return 0;
+}
+
+void mini_predecoded_close(mini_predecoded_t *image)
+{
+    assert(image != NULL);
+
+    if (image->map != NULL) munmap(image->map, image->map_size);
+    memset(image, 0, sizeof(*image));
+}
+
+MDI_size_t mini_predecoded_find(mini_predecoded_t *image, MDI_size_t offset)
+{
+    MDI_size_t low, high, idx;
+
+    assert(image != NULL);
+
+    if (offset < 0 || offset >= (MDI_size_t)image->offsets[image->count]) return -1;
+
+    /* Sequential decodes hit the Operation following the last one found. */
+    idx = image->hint;
+    if (idx >= image->count || image->offsets[idx] != (uint32_t)offset) {
+        low = 0;
+        high = image->count;
+        while (low < high) {
+            idx = low + (high - low) / 2;
+            if (image->offsets[idx] < (uint32_t)offset) low = idx + 1;
+            else high = idx;
+        }
+        idx = low;
+        if (idx >= image->count || image->offsets[idx] != (uint32_t)offset) return -1;
+    }
+    image->hint = idx + 1;
+    return idx;
+}
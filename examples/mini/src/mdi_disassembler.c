@@ -30,13 +30,86 @@
 
 #include <stdint.h>
 #include <stdlib.h>
-#include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <MDI/mdi.h>
 #include <MDI/mdi_operations.h>
 
 #define MAX_OPERANDS 4
 
+/*
+ * Integer to ascii conversions, writing exactly the number of
+ * characters given by the corresponding length functions.
+ */
+static size_t dis_ulen(uintptr_t value)
+{
+    size_t len = 1;
+    while (value >= 10) {
+        value /= 10;
+        len++;
+    }
+    return len;
+}
+
+static char *dis_utoa(char *out, uintptr_t value)
+{
+    char *end = out + dis_ulen(value);
+    char *current = end;
+    do {
+        *--current = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    return end;
+}
+
+static size_t dis_ilen(int32_t value)
+{
+    if (value < 0) return 1 + dis_ulen(0U - (uint32_t)value);
+    return dis_ulen((uint32_t)value);
+}
+
+static char *dis_itoa(char *out, int32_t value)
+{
+    if (value < 0) {
+        *out++ = '-';
+        return dis_utoa(out, 0U - (uint32_t)value);
+    }
+    return dis_utoa(out, (uint32_t)value);
+}
+
+static size_t dis_xlen(uintptr_t value)
+{
+    size_t len = 1;
+    while (value >= 16) {
+        value >>= 4;
+        len++;
+    }
+    return len;
+}
+
+static char *dis_xtoa(char *out, uintptr_t value)
+{
+    char *end = out + dis_xlen(value);
+    char *current = end;
+    do {
+        *--current = "0123456789abcdef"[value & 15];
+        value >>= 4;
+    } while (value != 0);
+    return end;
+}
+
+#define DIS_OPS_T const uint32_t *
+#define DIS_ULEN(value) dis_ulen(value)
+#define DIS_ILEN(value) dis_ilen((int32_t)(value))
+#define DIS_UTOA(out,value) dis_utoa(out, value)
+#define DIS_ITOA(out,value) dis_itoa(out, (int32_t)(value))
+#define DIS_LITERAL(out,literal,len) (memcpy(out, literal, len), (out) + (len))
+
+#include "generated_disassemblies.inc"
+
+/* Label and decode info characters in addition to DIS_MAX_LENGTH. */
+#define DIS_EXTRA_LENGTH 128
+
 typedef struct {
     MDI_interface_t mdi;
     MDI_Processor_t processor;
@@ -74,15 +147,17 @@ MDI_size_t MDI_Disassembler_disassemble(MDI_Disassembler_t self, MDI_Operation_t
 {
     char *current;
     char *limit;
+    char *out, *end;
+    char truncated[DIS_MAX_LENGTH + DIS_EXTRA_LENGTH];
     size_t offset;
     size_t nbytes;
-    int size;
+    size_t opcode_idx;
+    uintptr_t info_buffer = 0, info_offset = 0, info_end = 0;
     uint32_t parse_operands[MAX_OPERANDS];
     disassembler_t *disassembler;
     MDI_Operator_t operator;
     MDI_Processor_t processor;
     MDI_Opcode_t opcode;
-    MDI_str_t parsing;
     MDI_DecodeInfo_t decode_info;
     int i;
 
@@ -90,18 +165,17 @@ MDI_size_t MDI_Disassembler_disassemble(MDI_Disassembler_t self, MDI_Operation_t
     assert(operation != NULL);
     assert(buffer != NULL);
     assert(current_ptr != NULL);
-    assert((const char *)*current_ptr >= (const char *)buffer && (const char *)*current_ptr < (const char *)buffer + buffer_size);
+    assert((const char *)*current_ptr >= (const char *)buffer && (const char *)*current_ptr <= (const char *)buffer + buffer_size);
 
     current = *current_ptr;
     limit = buffer + buffer_size;
     offset = current - buffer;
-    nbytes = 0;
 
     disassembler = (disassembler_t *)self;
     processor = disassembler->processor;
     operator = MDI_Operation_operator(operation);
     opcode = MDI_Operator_opcode(operator, processor);
-    parsing = MDI_Opcode_parsing(opcode);
+    opcode_idx = (size_t)(intptr_t)opcode;
 
     /* Check that we don't have more operands than supported by this disassembler implementation. */
     /* This implementation only manage 32 bits operands. */
@@ -110,34 +184,53 @@ MDI_size_t MDI_Disassembler_disassemble(MDI_Disassembler_t self, MDI_Operation_t
         parse_operands[i] = (uint32_t)((intptr_t *)MDI_Operation_operands(operation))[i];
     }
 
-    size = snprintf(current, limit - current, "L%"PRIuPTR":\t", offset);
-    nbytes += size;
-    if (size >= limit - current) current = limit;
-    else current += size;
-
-    assert(MAX_OPERANDS == 4);
-    size = snprintf(current, limit - current, parsing,
-                    MDI_Instruction_mnemonic(MDI_Opcode_instruction(opcode)),
-                    parse_operands[0], parse_operands[1],
-                    parse_operands[2], parse_operands[3]);
-    nbytes += size;
-    if (size >= limit - current) current = limit;
-    else current += size;
-
+    /* The label is the decode offset if known, otherwise the disassembly buffer offset. */
     decode_info = MDI_Operation_decode_info(operation);
     if (decode_info) {
-        size = snprintf(current, limit - current, "\t\t//@0x%"PRIxPTR" + [%"PRIuPTR", %"PRIuPTR")",
-                        (intptr_t)MDI_DecodeInfo_buffer(decode_info),
-                        (intptr_t)MDI_DecodeInfo_offset(decode_info),
-                        (intptr_t)(MDI_DecodeInfo_offset(decode_info)+MDI_DecodeInfo_size(decode_info)));
-        if (size >= limit - current) current = limit;
-        else current += size;
+        info_buffer = (uintptr_t)MDI_DecodeInfo_buffer(decode_info);
+        info_offset = (uintptr_t)MDI_DecodeInfo_offset(decode_info);
+        info_end = info_offset + (uintptr_t)MDI_DecodeInfo_size(decode_info);
+        offset = info_offset;
+    }
+
+    /* Exact length of: "L<offset>:\t<operation>[\t\t//@0x<buffer> + [<offset>, <end>)]" */
+    nbytes = 1 + dis_ulen(offset) + 2;
+    nbytes += _disassembly_lengths[opcode_idx](parse_operands);
+    if (decode_info) {
+        nbytes += 7 + dis_xlen(info_buffer) + 4 + dis_ulen(info_offset) + 2 + dis_ulen(info_end) + 1;
     }
 
-    if (nbytes >= buffer_size)
-        buffer[buffer_size-1] = '\0';
+    /* Format in place when it fits, otherwise truncate a local copy. */
+    out = nbytes < (size_t)(limit - current) ? current: truncated;
+    assert(nbytes < sizeof(truncated));
+    end = out;
+    *end++ = 'L';
+    end = dis_utoa(end, offset);
+    end = DIS_LITERAL(end, ":\t", 2);
+    end = _disassemblies[opcode_idx](end, parse_operands);
+    if (decode_info) {
+        end = DIS_LITERAL(end, "\t\t//@0x", 7);
+        end = dis_xtoa(end, info_buffer);
+        end = DIS_LITERAL(end, " + [", 4);
+        end = dis_utoa(end, info_offset);
+        end = DIS_LITERAL(end, ", ", 2);
+        end = dis_utoa(end, info_end);
+        *end++ = ')';
+    }
+    *end = '\0';
+    assert((size_t)(end - out) == nbytes);
+
+    if (out == truncated) {
+        /* Nothing is emitted into an already full buffer. */
+        if (current < limit) {
+            memcpy(current, truncated, limit - current - 1);
+            limit[-1] = '\0';
+        }
+        current = limit;
+    } else {
+        current = end;
+    }
 
     *current_ptr = current;
     return nbytes;
 }
-
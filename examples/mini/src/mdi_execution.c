@@ -29,17 +29,26 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#if defined(__x86_64__)
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 #include <MDI/mdi.h>
 #include <MDI/mdi_operations.h>
+#include "mdi_params.h"
+#include "mdi_memory.h"
+#include "mdi_operation.h"
 
 #define RF_R32_COUNT 32
 #define RF_PC_COUNT 1
 #define RF_SAVE_COUNT 6
 #define RF_STAT_COUNT 1
 #define RF_TRAP_COUNT 16
-#define MEM_BYTES 4096
 
 typedef struct {
     uint32_t R32[RF_R32_COUNT];
@@ -49,13 +58,49 @@ typedef struct {
     uint32_t TRAP[RF_TRAP_COUNT];
 } mini_cpu_t;
 
-typedef char *mini_memory_t;
+typedef struct jit_s jit_t;
+
+/* Tiered run counter and promoted block of a branch target. */
+#define TIER_THRESHOLD 32
+#define TIER_CACHE_OPS 16384
+
+typedef struct {
+    int valid;
+    uint32_t pc;
+    uint32_t count;
+    uint32_t opcount;
+    uint64_t last_run;
+    MDI_ThreadedCode_t code;
+} tier_entry_t;
+
+typedef struct {
+    tier_entry_t *entries;
+    uint32_t mask;
+    uint32_t count;
+    uint32_t cached_ops;
+    uint64_t clock;
+} tier_table_t;
 
 typedef struct {
     MDI_interface_t interface;
     MDI_Processor_t processor;
     mini_cpu_t cpu;
     mini_memory_t mem;
+    int transactional;
+    int verbose;
+    int jit;
+    int tiered;
+    uint32_t tier_threshold;
+    uint32_t tier_cache;
+    /* Code buffer translation state for MDI_Execution_run(). */
+    MDI_ptr_t run_buffer;
+    MDI_size_t run_size;
+    MDI_Decoder_t run_decoder;
+    MDI_DecodeCache_t run_cache;
+    MDI_ThreadedCode_t run_code;
+    jit_t *run_jit;
+    tier_table_t run_tiers;
+    char *run_predecode;
 } execution_context_t;
 
 #define EXE_CTX_CPU(ctx) &(ctx->cpu)
@@ -67,30 +112,78 @@ typedef struct {
 
 #define EXE_CPU_RR(cpu,rf,idx) ((uint32_t)(cpu.rf[idx]))
 #define EXE_CPU_RS(cpu,rf,idx) *((uint32_t *)(&cpu.rf[idx]))
-#define EXE_MEM_FETCH32(mem,idx) (*((uint32_t *)(&mem[idx])))
-#define EXE_MEM_SLICE32(mem,idx) *((uint32_t *)(&mem[idx]))
+#define EXE_CPU_SNAPSHOT(cpu,rf) uint32_t _snapshot_##rf[sizeof((cpu)->rf) / sizeof((cpu)->rf[0])]; \
+    memcpy(_snapshot_##rf, (cpu)->rf, sizeof(_snapshot_##rf))
+#define EXE_SNAPSHOT_RR(rf,idx) ((uint32_t)(_snapshot_##rf[idx]))
+#define EXE_MEM_FETCH32(mem,idx) mini_memory_read32((mem), (idx))
+#define EXE_MEM_STORE32(mem,idx,value) mini_memory_write32((mem), (idx), (value))
+#define EXE_MEM_STATUS(mem) mini_memory_status(mem)
 #define EXE_OPS(operands,idx) ((uint32_t)operands[idx])
 #define EXE_CTX_T execution_context_t *
 #define EXE_OPS_T const intptr_t *
 #define CPU_T mini_cpu_t
 #define MEM_T mini_memory_t
 
+/*
+ * Threaded code operation, see MDI_ThreadedCode_init() below.
+ * Superinstructions execute a sequence of consecutive operations,
+ * super being the superinstruction index + 1 at the sequence start.
+ */
+#define OPERANDS_MAX 4
+
+typedef struct {
+    const void *handler;
+    uint32_t opcode_idx;
+    uint32_t pc;
+    uint32_t op_size;
+    uint32_t next;
+    uint32_t super;
+    intptr_t operands[OPERANDS_MAX];
+} threaded_op_t;
+
+#define EXE_SOPS_T const threaded_op_t *
+#define EXE_SOPS(ops,idx) ((ops)[idx].operands)
+#define EXE_SOPS_SIZE(ops,idx) ((ops)[idx].op_size)
+
 #include "generated_executions.inc"
 
 #define UNUSED(var) (void)(var)
 
+static void run_release(execution_context_t *context);
+
 MDI_res_t MDI_Execution_init(MDI_Execution_t *self_ref, MDI_interface_t mdi, MDI_Processor_t processor,
                              MDI_object_t params)
 {
     execution_context_t *context;
+    uint64_t mem_size, mem_page_size, tier_threshold, tier_cache;
 
     assert(self_ref != NULL);
-    UNUSED(params);
+
+    /* Sparse memory of "mem_size" bytes in pages of "mem_page_size" bytes. */
+    if (mini_params_uint(params, "mem_size", MINI_MEMORY_SIZE, &mem_size) != 0 ||
+        mini_params_uint(params, "mem_page_size", MINI_MEMORY_PAGE_SIZE, &mem_page_size) != 0 ||
+        mini_params_uint(params, "tier_threshold", TIER_THRESHOLD, &tier_threshold) != 0 ||
+        mini_params_uint(params, "tier_cache", TIER_CACHE_OPS, &tier_cache) != 0 ||
+        tier_threshold > UINT32_MAX || tier_cache > UINT32_MAX)
+        return -1;
 
     context = (execution_context_t *)calloc(1, sizeof(execution_context_t));
-    context->mem = (char *)calloc(MEM_BYTES, sizeof(char));
+    if (context == NULL) return -1;
+    if (mini_memory_init(&context->mem, mem_size, mem_page_size) != 0) {
+        free(context);
+        return -1;
+    }
     context->interface = mdi;
     context->processor = processor;
+    /* In-place state update unless "semantics=transactional" is given. */
+    context->transactional = mini_params_is(params, "semantics", "transactional");
+    /* Engine fallbacks are reported on stderr when "verbose" is given. */
+    context->verbose = mini_params_get(params, "verbose", NULL, NULL);
+    /* Threaded code run unless "engine=jit" or "engine=tiered" is given. */
+    context->jit = mini_params_is(params, "engine", "jit");
+    context->tiered = mini_params_is(params, "engine", "tiered");
+    context->tier_threshold = (uint32_t)tier_threshold;
+    context->tier_cache = (uint32_t)tier_cache;
 
     *self_ref = (MDI_Execution_t)context;
     
@@ -105,8 +198,9 @@ MDI_res_t MDI_Execution_fini(MDI_Execution_t *self_ref)
     context = (execution_context_t *)*self_ref;
     if (context == NULL) return -1;
 
-    free(context->mem);
-    context->mem = NULL;
+    run_release(context);
+    free(context->run_predecode);
+    mini_memory_fini(&context->mem);
     free(context);
     *self_ref = NULL;
     
@@ -141,35 +235,1254 @@ void MDI_Execution_stepout(MDI_Execution_t execution)
 {
 }
 
+/*
+ * Binds operation to the handlers table of the execution mode, the
+ * binding is then valid for all contexts with the same mode and
+ * Processor.
+ */
+static inline mini_binding_t *execution_bind(execution_context_t *execution, MDI_Operation_t operation)
+{
+    mini_binding_t *binding;
+    const EXE_FUNC_T *table;
+    MDI_DecodeInfo_t decode_info;
+    size_t opcode_idx;
+
+    binding = MINI_OPERATION_BINDING(operation);
+    table = execution->transactional ? _executions: _executions_inplace;
+    if (binding->key == table && binding->processor == execution->processor) return binding;
+
+    opcode_idx = (size_t)(intptr_t)MDI_Operator_opcode(MDI_Operation_operator(operation), execution->processor);
+    decode_info = MDI_Operation_decode_info(operation);
+    assert(decode_info != NULL);
+    binding->handler = (void (*)(void))table[opcode_idx];
+    binding->operands = (const intptr_t *)MDI_Operation_operands(operation);
+    binding->op_size = (uint32_t)MDI_DecodeInfo_size(decode_info);
+    binding->key = table;
+    binding->processor = execution->processor;
+    return binding;
+}
+
+MDI_res_t MDI_Execution_bind(MDI_Execution_t self, MDI_Operation_t operation)
+{
+    assert(self != NULL);
+    assert(operation != NULL);
+
+    execution_bind((execution_context_t *)self, operation);
+    return 0;
+}
+
 MDI_res_t MDI_Execution_execute(MDI_Execution_t self, MDI_Operation_t operation)
 {
     execution_context_t *execution;
-    size_t op_size;
+    mini_binding_t *binding;
     int res;
-    const intptr_t *exec_operands;
-    MDI_Opcode_t opcode;
-    MDI_Operator_t operator;
-    MDI_Processor_t processor;
-    MDI_DecodeInfo_t decode_info;
-    size_t opcode_idx;
 
     assert(self != NULL);
     execution = (execution_context_t *)self;
     assert(operation != NULL);
 
-    processor = execution->processor;
-    operator = MDI_Operation_operator(operation);
-    opcode = MDI_Operator_opcode(operator, processor);
-    opcode_idx = (size_t)(intptr_t)opcode;
-    decode_info = MDI_Operation_decode_info(operation);
-    assert(decode_info != NULL);
-    op_size = MDI_DecodeInfo_size(decode_info);
-
-    exec_operands = (const intptr_t *)MDI_Operation_operands(operation);
+    binding = execution_bind(execution, operation);
 
     MDI_Execution_stepin(self);
-    res = _executions[opcode_idx](execution, exec_operands, op_size);
+    res = ((EXE_FUNC_T)binding->handler)(execution, binding->operands, binding->op_size);
     MDI_Execution_stepout(self);
 
     return res;
 }
+
+/*
+ * Threaded code: each translated operation holds its handler
+ * and its resolved operands, the handlers being the generated
+ * execution functions, inlined in the dispatch loop.
+ * With GNU C the dispatch is done with computed gotos, replicated
+ * at the end of each handler, otherwise through a switch.
+ */
+#define THREADED_NONE ((uint32_t)-1)
+
+typedef struct {
+    execution_context_t *execution;
+    threaded_op_t *ops;
+    uint32_t count;
+    uint32_t base_pc;
+    uint32_t limit_pc;
+    uint32_t *pc_index;
+    int resolved;
+} threaded_code_t;
+
+static int threaded_op_compare(const void *a, const void *b)
+{
+    const threaded_op_t *op_a = (const threaded_op_t *)a;
+    const threaded_op_t *op_b = (const threaded_op_t *)b;
+    return op_a->pc < op_b->pc ? -1: op_a->pc > op_b->pc;
+}
+
+/*
+ * Allocates a ThreadedCode for count Operations, to be filled
+ * then linked by threaded_link().
+ */
+static threaded_code_t *threaded_alloc(execution_context_t *context, MDI_size_t count)
+{
+    threaded_code_t *code;
+
+    code = (threaded_code_t *)calloc(1, sizeof(threaded_code_t));
+    if (code == NULL) return NULL;
+    code->execution = context;
+    code->count = (uint32_t)count;
+    code->ops = (threaded_op_t *)calloc(count > 0 ? count: 1, sizeof(threaded_op_t));
+    if (code->ops == NULL) {
+        free(code);
+        return NULL;
+    }
+    return code;
+}
+
+static void threaded_free(threaded_code_t *code)
+{
+    free(code->pc_index);
+    free(code->ops);
+    free(code);
+}
+
+/*
+ * Returns the index + 1 of the longest superinstruction matching
+ * the fall through sequence starting at ops[i], 0 if none.
+ */
+static uint32_t threaded_super(const threaded_code_t *code, uint32_t i)
+{
+    uint32_t k, j, n;
+
+    for (k = 0; k < EXE_SUPERS_COUNT; k++) {
+        n = _supers[k][0];
+        for (j = 0; j < n; j++) {
+            if (i + j >= code->count || code->ops[i + j].opcode_idx != _supers[k][1 + j]) break;
+            if (j + 1 < n && code->ops[i + j].next != i + j + 1) break;
+        }
+        if (j == n) return k + 1;
+    }
+    return 0;
+}
+
+static int threaded_link(threaded_code_t *code, int fusion)
+{
+    threaded_op_t *op;
+    uint32_t i;
+
+    qsort(code->ops, code->count, sizeof(threaded_op_t), threaded_op_compare);
+
+    /* Map code range PCs to operations and link fall through successors. */
+    if (code->count > 0) {
+        code->base_pc = code->ops[0].pc;
+        code->limit_pc = code->ops[code->count - 1].pc + code->ops[code->count - 1].op_size;
+    }
+    code->pc_index = (uint32_t *)malloc(((size_t)(code->limit_pc - code->base_pc) + 1) * sizeof(uint32_t));
+    if (code->pc_index == NULL) return -1;
+    memset(code->pc_index, 0xff, ((size_t)(code->limit_pc - code->base_pc) + 1) * sizeof(uint32_t));
+    for (i = 0; i < code->count; i++) {
+        op = &code->ops[i];
+        code->pc_index[op->pc - code->base_pc] = i;
+        op->next = THREADED_NONE;
+        if (i + 1 < code->count && code->ops[i + 1].pc == op->pc + op->op_size)
+            op->next = i + 1;
+    }
+    if (fusion) {
+        for (i = 0; i < code->count; i++)
+            code->ops[i].super = threaded_super(code, i);
+    }
+    return 0;
+}
+
+MDI_res_t MDI_ThreadedCode_init(MDI_ThreadedCode_t *self_ref, MDI_Execution_t execution, const MDI_Operation_t *operations, MDI_size_t count, MDI_object_t params)
+{
+    threaded_code_t *code;
+    threaded_op_t *op;
+    execution_context_t *context;
+    MDI_DecodeInfo_t decode_info;
+    const intptr_t *operands;
+    MDI_size_t opcount;
+    uint32_t i, j;
+
+    assert(self_ref != NULL);
+    assert(execution != NULL);
+    assert(count >= 0);
+    context = (execution_context_t *)execution;
+
+    code = threaded_alloc(context, count);
+    if (code == NULL) return -1;
+
+    for (i = 0; i < code->count; i++) {
+        op = &code->ops[i];
+        decode_info = MDI_Operation_decode_info(operations[i]);
+        assert(decode_info != NULL);
+        opcount = MDI_Operation_opcount(operations[i]);
+        if (opcount > OPERANDS_MAX) goto error;
+        op->opcode_idx = (uint32_t)(intptr_t)MDI_Operator_opcode(MDI_Operation_operator(operations[i]),
+                                                                  context->processor);
+        op->pc = (uint32_t)MDI_DecodeInfo_offset(decode_info);
+        op->op_size = (uint32_t)MDI_DecodeInfo_size(decode_info);
+        operands = (const intptr_t *)MDI_Operation_operands(operations[i]);
+        for (j = 0; j < opcount; j++) {
+            op->operands[j] = operands[j];
+        }
+    }
+    /* Superinstructions are used unless "fusion=off" is given. */
+    if (threaded_link(code, !mini_params_is(params, "fusion", "off")) != 0) goto error;
+
+    *self_ref = (MDI_ThreadedCode_t)code;
+    return 0;
+ error:
+    threaded_free(code);
+    return -1;
+}
+
+MDI_res_t MDI_ThreadedCode_init_program(MDI_ThreadedCode_t *self_ref, MDI_Execution_t execution, MDI_Program_t program, MDI_object_t params)
+{
+    threaded_code_t *code;
+    threaded_op_t *op;
+    execution_context_t *context;
+    const uint16_t *operators;
+    const uint32_t *offsets, *sizes, *operand_starts;
+    const intptr_t *operands;
+    uint32_t i, j, opcount;
+
+    assert(self_ref != NULL);
+    assert(execution != NULL);
+    assert(program != NULL);
+    context = (execution_context_t *)execution;
+
+    code = threaded_alloc(context, MDI_Program_count(program));
+    if (code == NULL) return -1;
+
+    operators = MDI_Program_operators(program);
+    offsets = MDI_Program_offsets(program);
+    sizes = MDI_Program_sizes(program);
+    operand_starts = MDI_Program_operand_starts(program);
+    operands = MDI_Program_operands(program);
+    for (i = 0; i < code->count; i++) {
+        op = &code->ops[i];
+        opcount = operand_starts[i + 1] - operand_starts[i];
+        if (opcount > OPERANDS_MAX) goto error;
+        op->opcode_idx = (uint32_t)(intptr_t)MDI_Operator_opcode(MDI_Operators_iter(context->interface, operators[i]),
+                                                                  context->processor);
+        op->pc = offsets[i];
+        op->op_size = sizes[i];
+        for (j = 0; j < opcount; j++) {
+            op->operands[j] = operands[operand_starts[i] + j];
+        }
+    }
+    /* Superinstructions are used unless "fusion=off" is given. */
+    if (threaded_link(code, !mini_params_is(params, "fusion", "off")) != 0) goto error;
+
+    *self_ref = (MDI_ThreadedCode_t)code;
+    return 0;
+ error:
+    threaded_free(code);
+    return -1;
+}
+
+MDI_res_t MDI_ThreadedCode_fini(MDI_ThreadedCode_t *self_ref)
+{
+    threaded_code_t *code;
+
+    assert(self_ref != NULL);
+    code = (threaded_code_t *)*self_ref;
+    if (code == NULL) return -1;
+
+    threaded_free(code);
+    *self_ref = NULL;
+    return 0;
+}
+
+static threaded_op_t *threaded_lookup(const threaded_code_t *code, uint32_t pc)
+{
+    uint32_t idx;
+
+    if (pc < code->base_pc || pc >= code->limit_pc) return NULL;
+    idx = code->pc_index[pc - code->base_pc];
+    if (idx == THREADED_NONE) return NULL;
+    return &code->ops[idx];
+}
+
+/*
+ * Returns whether the n operations superinstruction starting at op
+ * can be executed at once, i.e. without stopping before its end.
+ * Only the last operation may branch, hence only the steps count
+ * and the stop PC need to be checked for the inner operations.
+ */
+static inline int threaded_fusable(const threaded_op_t *op, uint32_t n, MDI_size_t steps,
+                                   MDI_size_t max_steps, MDI_size_t stop_pc)
+{
+    uint32_t j;
+
+    if (max_steps != 0 && max_steps - steps < n) return 0;
+    for (j = 1; j < n; j++) {
+        if (op[j].pc == stop_pc) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Executes op, then checks stop conditions in the documented order,
+ * and sets op to the next operation to execute.
+ */
+#define THREADED_STEP()                                                 \
+    do {                                                                \
+        next_pc = context->cpu.PC[0];                                   \
+        steps++;                                                        \
+        if (res != 0) { stop = MDI_EXECUTION_FAULT_EXECUTE; goto threaded_end; } \
+        if (next_pc == op->pc) { stop = MDI_EXECUTION_STOP_LOOP; goto threaded_end; } \
+        if (next_pc == stop_pc) { stop = MDI_EXECUTION_STOP_PC; goto threaded_end; } \
+        if (steps == max_steps) { stop = MDI_EXECUTION_STOP_STEPS; goto threaded_end; } \
+        if (op->next != THREADED_NONE && next_pc == op->pc + op->op_size) \
+            op = &code->ops[op->next];                                  \
+        else if ((op = threaded_lookup(code, next_pc)) == NULL) {       \
+            stop = MDI_EXECUTION_STOP_EXIT; goto threaded_end;          \
+        }                                                               \
+    } while (0)
+
+MDI_res_t MDI_Execution_run_threaded(MDI_Execution_t self, MDI_ThreadedCode_t threaded_code, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref)
+{
+    execution_context_t *context;
+    threaded_code_t *code;
+    threaded_op_t *op;
+    MDI_size_t steps = 0;
+    MDI_size_t next_pc;
+    MDI_res_t stop;
+    int32_t res;
+    uint32_t count = 0;
+#if defined(__GNUC__)
+#define THREADED_LABEL(idx) &&_threaded_##idx,
+    static const void *const labels[] = { EXE_FOREACH_EXECUTION(THREADED_LABEL) };
+#undef THREADED_LABEL
+#define THREADED_LABEL(k, n) &&_threaded_super_##k,
+    static const void *const super_labels[EXE_SUPERS_COUNT + 1] = { EXE_FOREACH_SUPER(THREADED_LABEL) };
+#undef THREADED_LABEL
+    uint32_t i;
+#endif
+
+    assert(self != NULL);
+    assert(threaded_code != NULL);
+    context = (execution_context_t *)self;
+    code = (threaded_code_t *)threaded_code;
+    assert(code->execution == context);
+
+#if defined(__GNUC__)
+    if (!code->resolved) {
+        for (i = 0; i < code->count; i++) {
+            code->ops[i].handler = code->ops[i].super != 0 ?
+                super_labels[code->ops[i].super - 1]: labels[code->ops[i].opcode_idx];
+        }
+        code->resolved = 1;
+    }
+#endif
+
+    op = threaded_lookup(code, context->cpu.PC[0]);
+    if (op == NULL) {
+        stop = MDI_EXECUTION_STOP_EXIT;
+        goto threaded_end;
+    }
+
+#if defined(__GNUC__)
+    goto *op->handler;
+#define THREADED_HANDLER(idx)                                           \
+    _threaded_##idx:                                                    \
+        if (context->transactional)                                     \
+            res = _execution_##idx(context, op->operands, op->op_size); \
+        else                                                            \
+            res = _execution_inplace_##idx(context, op->operands, op->op_size); \
+        THREADED_STEP();                                                \
+        goto *op->handler;
+    EXE_FOREACH_EXECUTION(THREADED_HANDLER)
+#undef THREADED_HANDLER
+    /*
+     * A superinstruction steps over its n operations at once, or up to
+     * a failing one.
+     */
+#define THREADED_SUPER(k, n)                                            \
+    _threaded_super_##k:                                                \
+        if (!threaded_fusable(op, n, steps, max_steps, stop_pc))        \
+            goto *labels[op->opcode_idx];                               \
+        if (context->transactional)                                     \
+            res = _execution_super_##k(context, op, &count);            \
+        else                                                            \
+            res = _execution_inplace_super_##k(context, op, &count);    \
+        steps += count - 1;                                             \
+        op += count - 1;                                                \
+        THREADED_STEP();                                                \
+        goto *op->handler;
+    EXE_FOREACH_SUPER(THREADED_SUPER)
+#undef THREADED_SUPER
+#else
+    while (1) {
+        if (op->super != 0 &&
+            threaded_fusable(op, _supers[op->super - 1][0], steps, max_steps, stop_pc)) {
+            switch (op->super - 1) {
+#define THREADED_SUPER(k, n)                                            \
+            case k:                                                     \
+                if (context->transactional)                             \
+                    res = _execution_super_##k(context, op, &count);    \
+                else                                                    \
+                    res = _execution_inplace_super_##k(context, op, &count); \
+                steps += count - 1;                                     \
+                op += count - 1;                                        \
+                break;
+            EXE_FOREACH_SUPER(THREADED_SUPER)
+#undef THREADED_SUPER
+            }
+            THREADED_STEP();
+            continue;
+        }
+        switch (op->opcode_idx) {
+#define THREADED_HANDLER(idx)                                           \
+        case idx:                                                       \
+            if (context->transactional)                                 \
+                res = _execution_##idx(context, op->operands, op->op_size); \
+            else                                                        \
+                res = _execution_inplace_##idx(context, op->operands, op->op_size); \
+            break;
+        EXE_FOREACH_EXECUTION(THREADED_HANDLER)
+#undef THREADED_HANDLER
+        default:
+            res = -1;
+        }
+        THREADED_STEP();
+    }
+#endif
+
+ threaded_end:
+    if (steps_ref != NULL) *steps_ref = steps;
+    return stop;
+}
+
+/*
+ * JIT: with "engine=jit", MDI_Execution_run() translates the basic
+ * blocks of the threaded code into x86-64 code, in an executable code
+ * cache flushed when full. Guest registers stay in mini_cpu_t, the
+ * operations not translated natively call their execution function.
+ * A block checks on entry that the steps budget and the stop PC let
+ * it run to its end, otherwise a single operation is executed from
+ * the threaded code. Direct branches are chained to their target
+ * block once both are translated.
+ * The code cache is never writable and executable at once: emitted
+ * code is made read only executable, and writable again only while
+ * overwritten after a flush or patched when chaining.
+ * Generated code registers: rbx the CPU, r12 the remaining steps,
+ * r13 the stop PC, r14 the context, r15 the jit_state_t.
+ */
+#if defined(__x86_64__)
+
+#define JIT_CACHE_SIZE (1024 * 1024)
+#define JIT_BLOCK_MAX 32
+
+#define JIT_EXIT_NEXT 0
+#define JIT_EXIT_FALLBACK 1
+#define JIT_EXIT_LOOP 2
+#define JIT_EXIT_STOP_PC 3
+#define JIT_EXIT_STEPS 4
+#define JIT_EXIT_FAULT 5
+
+#define JIT_R32(idx) ((uint32_t)(offsetof(mini_cpu_t, R32) + sizeof(uint32_t) * (uint32_t)(idx)))
+#define JIT_PC ((uint32_t)offsetof(mini_cpu_t, PC))
+
+typedef struct {
+    uint64_t budget;
+    int64_t stop_pc;
+    uint8_t *site;
+} jit_state_t;
+
+typedef char jit_state_check[offsetof(jit_state_t, stop_pc) == 8 && offsetof(jit_state_t, site) == 16 ? 1: -1];
+
+typedef uint32_t (*jit_enter_t)(mini_cpu_t *cpu, execution_context_t *context, jit_state_t *state, const uint8_t *entry);
+
+struct jit_s {
+    execution_context_t *context;
+    threaded_code_t *code;
+    const EXE_FUNC_T *table;
+    uint8_t *base;
+    size_t size;
+    size_t page_size;
+    size_t used;
+    size_t start;
+    int overflow;
+    int failed;
+    uint32_t generation;
+    jit_enter_t enter;
+    const uint8_t *epilogue;
+    const uint8_t **entries;
+};
+
+static void jit_bytes(jit_t *jit, const uint8_t *bytes, size_t size)
+{
+    if (jit->overflow || jit->size - jit->used < size) {
+        jit->overflow = 1;
+        return;
+    }
+    memcpy(jit->base + jit->used, bytes, size);
+    jit->used += size;
+}
+
+static void jit_u8(jit_t *jit, uint8_t value)
+{
+    jit_bytes(jit, &value, 1);
+}
+
+static void jit_u32(jit_t *jit, uint32_t value)
+{
+    uint8_t bytes[4];
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+    jit_bytes(jit, bytes, 4);
+}
+
+static void jit_u64(jit_t *jit, uint64_t value)
+{
+    jit_u32(jit, (uint32_t)value);
+    jit_u32(jit, (uint32_t)(value >> 32));
+}
+
+#define JIT_EMIT(jit, ...)                                              \
+    do {                                                                \
+        static const uint8_t _bytes[] = { __VA_ARGS__ };                \
+        jit_bytes(jit, _bytes, sizeof(_bytes));                         \
+    } while (0)
+
+static uint8_t *jit_here(jit_t *jit)
+{
+    return jit->base + jit->used;
+}
+
+static void jit_patch_rel32(uint8_t *at, const uint8_t *target)
+{
+    int32_t rel = (int32_t)(target - (at + 4));
+    memcpy(at, &rel, sizeof(rel));
+}
+
+/*
+ * Sets the protection of the code cache pages over [from, to[.
+ * Returns 0 on success, on failure the code cache is not used anymore.
+ */
+static int jit_protect(jit_t *jit, size_t from, size_t to, int prot)
+{
+    from &= ~(jit->page_size - 1);
+    to = (to + jit->page_size - 1) & ~(jit->page_size - 1);
+    if (to > jit->size) to = jit->size;
+    if (from >= to) return 0;
+    if (mprotect(jit->base + from, to - from, prot) != 0 && !jit->failed) {
+        jit->failed = 1;
+        if (jit->context->verbose)
+            fprintf(stderr, "mini: JIT code cache protection failed, running threaded code\n");
+    }
+    return jit->failed ? -1: 0;
+}
+
+#define JIT_PROT_WRITE (PROT_READ | PROT_WRITE)
+#define JIT_PROT_EXEC (PROT_READ | PROT_EXEC)
+
+/* Emits rel32 relative to the end of the emitted field. */
+static void jit_rel32(jit_t *jit, const uint8_t *target)
+{
+    jit_u32(jit, (uint32_t)(int32_t)(target - (jit_here(jit) + 4)));
+}
+
+/* mov eax, [rbx + disp] */
+static void jit_load_eax(jit_t *jit, uint32_t disp)
+{
+    JIT_EMIT(jit, 0x8b, 0x83);
+    jit_u32(jit, disp);
+}
+
+/* mov [rbx + disp], eax */
+static void jit_store_eax(jit_t *jit, uint32_t disp)
+{
+    JIT_EMIT(jit, 0x89, 0x83);
+    jit_u32(jit, disp);
+}
+
+/* mov dword [rbx + disp], imm */
+static void jit_store_imm(jit_t *jit, uint32_t disp, uint32_t imm)
+{
+    JIT_EMIT(jit, 0xc7, 0x83);
+    jit_u32(jit, disp);
+    jit_u32(jit, imm);
+}
+
+/* Exits to the dispatcher with reason, 10 bytes. */
+static void jit_exit(jit_t *jit, uint32_t reason)
+{
+    jit_u8(jit, 0xb8);                  /* mov eax, reason */
+    jit_u32(jit, reason);
+    jit_u8(jit, 0xe9);                  /* jmp epilogue */
+    jit_rel32(jit, jit->epilogue);
+}
+
+/* Exits with reason unless the jcc8 condition holds. */
+static void jit_exit_unless(jit_t *jit, uint8_t jcc8, uint32_t reason)
+{
+    jit_u8(jit, jcc8);
+    jit_u8(jit, 10);
+    jit_exit(jit, reason);
+}
+
+/*
+ * Sets the PC to next_pc, then checks stop conditions in the order
+ * of THREADED_STEP() and exits to the next block through a jump
+ * patched when chaining.
+ */
+static void jit_tail_const(jit_t *jit, uint32_t pc, uint32_t next_pc)
+{
+    uint8_t *site;
+
+    jit_store_imm(jit, JIT_PC, next_pc);
+    if (next_pc == pc) {
+        jit_exit(jit, JIT_EXIT_LOOP);
+        return;
+    }
+    jit_u8(jit, 0xb8);                  /* mov eax, next_pc */
+    jit_u32(jit, next_pc);
+    JIT_EMIT(jit, 0x49, 0x39, 0xc5);    /* cmp r13, rax */
+    jit_exit_unless(jit, 0x75, JIT_EXIT_STOP_PC);
+    JIT_EMIT(jit, 0x4d, 0x85, 0xe4);    /* test r12, r12 */
+    jit_exit_unless(jit, 0x75, JIT_EXIT_STEPS);
+    site = jit_here(jit);
+    JIT_EMIT(jit, 0xe9, 0x00, 0x00, 0x00, 0x00); /* jmp next block, or below */
+    JIT_EMIT(jit, 0x48, 0xba);          /* mov rdx, site */
+    jit_u64(jit, (uint64_t)(uintptr_t)site);
+    jit_exit(jit, JIT_EXIT_NEXT);
+}
+
+/* Same as jit_tail_const() for a next PC in eax, exits unchained. */
+static void jit_tail_eax(jit_t *jit, uint32_t pc)
+{
+    jit_store_eax(jit, JIT_PC);
+    jit_u8(jit, 0x3d);                  /* cmp eax, pc */
+    jit_u32(jit, pc);
+    jit_exit_unless(jit, 0x75, JIT_EXIT_LOOP);
+    JIT_EMIT(jit, 0x49, 0x39, 0xc5);    /* cmp r13, rax */
+    jit_exit_unless(jit, 0x75, JIT_EXIT_STOP_PC);
+    JIT_EMIT(jit, 0x4d, 0x85, 0xe4);    /* test r12, r12 */
+    jit_exit_unless(jit, 0x75, JIT_EXIT_STEPS);
+    JIT_EMIT(jit, 0x31, 0xd2);          /* xor edx, edx */
+    jit_exit(jit, JIT_EXIT_NEXT);
+}
+
+/*
+ * Calls the execution function of op, the k-th of a n operations
+ * block, and exits on fault with the steps of the block not
+ * executed given back.
+ */
+static void jit_call(jit_t *jit, const threaded_op_t *op, uint32_t k, uint32_t n)
+{
+    jit_store_imm(jit, JIT_PC, op->pc);
+    JIT_EMIT(jit, 0x4c, 0x89, 0xf7);    /* mov rdi, r14 */
+    JIT_EMIT(jit, 0x48, 0xbe);          /* mov rsi, operands */
+    jit_u64(jit, (uint64_t)(uintptr_t)op->operands);
+    jit_u8(jit, 0xba);                  /* mov edx, op_size */
+    jit_u32(jit, op->op_size);
+    JIT_EMIT(jit, 0x48, 0xb8);          /* mov rax, handler */
+    jit_u64(jit, (uint64_t)(uintptr_t)jit->table[op->opcode_idx]);
+    JIT_EMIT(jit, 0xff, 0xd0);          /* call rax */
+    JIT_EMIT(jit, 0x85, 0xc0);          /* test eax, eax */
+    jit_u8(jit, 0x74);                  /* je over the fault exit */
+    jit_u8(jit, 17);
+    JIT_EMIT(jit, 0x49, 0x81, 0xc4);    /* add r12, n - k - 1 */
+    jit_u32(jit, n - k - 1);
+    jit_exit(jit, JIT_EXIT_FAULT);
+}
+
+/* Returns whether op is translated natively. */
+static int jit_native(const threaded_op_t *op)
+{
+#define JIT_REG(idx) ((uint32_t)op->operands[idx] < RF_R32_COUNT)
+    switch (op->opcode_idx) {
+    case EXE_OPCODE_MV: return JIT_REG(0);
+    case EXE_OPCODE_ADD:
+    case EXE_OPCODE_SUB: return JIT_REG(0) && JIT_REG(1) && JIT_REG(2);
+    case EXE_OPCODE_BR:
+    case EXE_OPCODE_CALL:
+    case EXE_OPCODE_RET: return 1;
+    case EXE_OPCODE_BZ:
+    case EXE_OPCODE_BN:
+    case EXE_OPCODE_JR: return JIT_REG(0);
+    default: return 0;
+    }
+#undef JIT_REG
+}
+
+static void jit_emit_op(jit_t *jit, const threaded_op_t *op, uint32_t k, uint32_t n)
+{
+    uint32_t next_pc = op->pc + op->op_size;
+    uint32_t target;
+    uint8_t *jcc;
+
+    if (!jit_native(op)) {
+        jit_call(jit, op, k, n);
+        if (_executions_control[op->opcode_idx]) {
+            jit_load_eax(jit, JIT_PC);
+            jit_tail_eax(jit, op->pc);
+        } else if (k == n - 1) {
+            jit_tail_const(jit, op->pc, next_pc);
+        }
+        return;
+    }
+    switch (op->opcode_idx) {
+    case EXE_OPCODE_MV:
+        jit_store_imm(jit, JIT_R32(op->operands[0]), (uint32_t)op->operands[1]);
+        break;
+    case EXE_OPCODE_ADD:
+    case EXE_OPCODE_SUB:
+        jit_load_eax(jit, JIT_R32(op->operands[1]));
+        jit_u8(jit, op->opcode_idx == EXE_OPCODE_ADD ? 0x03: 0x2b); /* add/sub eax, [rbx + disp] */
+        jit_u8(jit, 0x83);
+        jit_u32(jit, JIT_R32(op->operands[2]));
+        jit_store_eax(jit, JIT_R32(op->operands[0]));
+        break;
+    case EXE_OPCODE_BR:
+        jit_tail_const(jit, op->pc, op->pc + (uint32_t)op->operands[0]);
+        return;
+    case EXE_OPCODE_BZ:
+    case EXE_OPCODE_BN:
+        target = op->pc + (uint32_t)op->operands[1];
+        JIT_EMIT(jit, 0x83, 0xbb);      /* cmp dword [rbx + disp], 0 */
+        jit_u32(jit, JIT_R32(op->operands[0]));
+        jit_u8(jit, 0x00);
+        jit_u8(jit, 0x0f);              /* jcc not taken */
+        jit_u8(jit, op->opcode_idx == EXE_OPCODE_BZ ? 0x85: 0x84);
+        jcc = jit_here(jit);
+        jit_u32(jit, 0);
+        jit_tail_const(jit, op->pc, target);
+        if (!jit->overflow) jit_patch_rel32(jcc, jit_here(jit));
+        jit_tail_const(jit, op->pc, next_pc);
+        return;
+    case EXE_OPCODE_JR:
+        jit_load_eax(jit, JIT_R32(op->operands[0]));
+        jit_tail_eax(jit, op->pc);
+        return;
+    case EXE_OPCODE_CALL:
+        jit_store_imm(jit, JIT_R32(14), next_pc);
+        jit_tail_const(jit, op->pc, op->pc + (uint32_t)op->operands[0]);
+        return;
+    case EXE_OPCODE_RET:
+        jit_load_eax(jit, JIT_R32(14));
+        jit_tail_eax(jit, op->pc);
+        return;
+    }
+    if (k == n - 1) jit_tail_const(jit, op->pc, next_pc);
+}
+
+/*
+ * Translates the block starting at operation idx: fall through
+ * operations up to a control one.
+ * Returns the block entry, or NULL if the code cache is full.
+ */
+static const uint8_t *jit_emit_block(jit_t *jit, uint32_t idx)
+{
+    const threaded_op_t *ops = &jit->code->ops[idx];
+    uint8_t *entry;
+    size_t used = jit->used;
+    uint32_t n, k;
+
+    n = 1;
+    while (n < JIT_BLOCK_MAX && !_executions_control[ops[n - 1].opcode_idx] &&
+           ops[n - 1].next != THREADED_NONE)
+        n++;
+
+    jit->overflow = 0;
+    /* Only the page holding the code end may be executable after it. */
+    if (jit_protect(jit, used, used + 1, JIT_PROT_WRITE) != 0) return NULL;
+    entry = jit_here(jit);
+    JIT_EMIT(jit, 0x49, 0x81, 0xfc);    /* cmp r12, n */
+    jit_u32(jit, n);
+    jit_exit_unless(jit, 0x73, JIT_EXIT_FALLBACK);
+    if (n > 1) {
+        /* Stop PC in (first pc, last pc]. */
+        JIT_EMIT(jit, 0x4c, 0x89, 0xe8); /* mov rax, r13 */
+        jit_u8(jit, 0xb9);              /* mov ecx, first pc + 1 */
+        jit_u32(jit, ops[0].pc + 1);
+        JIT_EMIT(jit, 0x48, 0x29, 0xc8); /* sub rax, rcx */
+        jit_u8(jit, 0xb9);              /* mov ecx, last pc - first pc - 1 */
+        jit_u32(jit, ops[n - 1].pc - ops[0].pc - 1);
+        JIT_EMIT(jit, 0x48, 0x39, 0xc8); /* cmp rax, rcx */
+        jit_exit_unless(jit, 0x77, JIT_EXIT_FALLBACK);
+    }
+    JIT_EMIT(jit, 0x49, 0x81, 0xec);    /* sub r12, n */
+    jit_u32(jit, n);
+    for (k = 0; k < n; k++)
+        jit_emit_op(jit, &ops[k], k, n);
+
+    if (jit->overflow) {
+        jit->used = used;
+        entry = NULL;
+    }
+    if (jit_protect(jit, used, jit->used, JIT_PROT_EXEC) != 0) return NULL;
+    return entry;
+}
+
+static void jit_flush(jit_t *jit)
+{
+    memset(jit->entries, 0, (jit->code->count > 0 ? jit->code->count: 1) * sizeof(*jit->entries));
+    jit->used = jit->start;
+    jit->generation++;
+    (void)jit_protect(jit, jit->start, jit->size, JIT_PROT_WRITE);
+}
+
+static const uint8_t *jit_translate(jit_t *jit, uint32_t idx)
+{
+    const uint8_t *entry;
+
+    entry = jit_emit_block(jit, idx);
+    if (entry == NULL) {
+        jit_flush(jit);
+        entry = jit_emit_block(jit, idx);
+    }
+    jit->entries[idx] = entry;
+    return entry;
+}
+
+static jit_t *jit_init(execution_context_t *context, threaded_code_t *code)
+{
+    jit_t *jit;
+    void *base;
+
+    jit = (jit_t *)calloc(1, sizeof(jit_t));
+    if (jit == NULL) return NULL;
+    jit->entries = (const uint8_t **)calloc(code->count > 0 ? code->count: 1, sizeof(*jit->entries));
+    base = mmap(NULL, JIT_CACHE_SIZE, JIT_PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (jit->entries == NULL || base == MAP_FAILED) {
+        free(jit->entries);
+        free(jit);
+        return NULL;
+    }
+    jit->context = context;
+    jit->code = code;
+    jit->table = context->transactional ? _executions: _executions_inplace;
+    jit->base = (uint8_t *)base;
+    jit->size = JIT_CACHE_SIZE;
+    jit->page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    /* Entry: saves callee saved registers, keeping the stack aligned for calls. */
+    jit->enter = (jit_enter_t)(uintptr_t)jit_here(jit);
+    JIT_EMIT(jit,
+             0x53,                      /* push rbx */
+             0x41, 0x54,                /* push r12 */
+             0x41, 0x55,                /* push r13 */
+             0x41, 0x56,                /* push r14 */
+             0x41, 0x57,                /* push r15 */
+             0x48, 0x89, 0xfb,          /* mov rbx, rdi */
+             0x49, 0x89, 0xf6,          /* mov r14, rsi */
+             0x49, 0x89, 0xd7,          /* mov r15, rdx */
+             0x4d, 0x8b, 0x27,          /* mov r12, [r15] */
+             0x4d, 0x8b, 0x6f, 0x08,    /* mov r13, [r15 + 8] */
+             0xff, 0xe1);               /* jmp rcx */
+    /* Epilogue: eax the exit reason, rdx the chaining site. */
+    jit->epilogue = jit_here(jit);
+    JIT_EMIT(jit,
+             0x4d, 0x89, 0x27,          /* mov [r15], r12 */
+             0x49, 0x89, 0x57, 0x10,    /* mov [r15 + 16], rdx */
+             0x41, 0x5f,                /* pop r15 */
+             0x41, 0x5e,                /* pop r14 */
+             0x41, 0x5d,                /* pop r13 */
+             0x41, 0x5c,                /* pop r12 */
+             0x5b,                      /* pop rbx */
+             0xc3);                     /* ret */
+    jit->start = jit->used;
+    if (jit_protect(jit, 0, jit->start, JIT_PROT_EXEC) != 0) {
+        munmap(jit->base, jit->size);
+        free(jit->entries);
+        free(jit);
+        return NULL;
+    }
+    return jit;
+}
+
+static void jit_fini(jit_t *jit)
+{
+    munmap(jit->base, jit->size);
+    free(jit->entries);
+    free(jit);
+}
+
+/*
+ * Same as MDI_Execution_run_threaded() on the JIT threaded code.
+ */
+static MDI_res_t jit_run(jit_t *jit, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref)
+{
+    execution_context_t *context = jit->context;
+    threaded_code_t *code = jit->code;
+    const threaded_op_t *op;
+    const uint8_t *entry;
+    jit_state_t state;
+    uint8_t *site = NULL;
+    uint32_t generation = jit->generation;
+    uint32_t reason;
+    uint64_t budget;
+    MDI_size_t steps = 0, run_steps;
+    MDI_res_t stop;
+
+    while (1) {
+        op = threaded_lookup(code, context->cpu.PC[0]);
+        if (op == NULL) {
+            stop = MDI_EXECUTION_STOP_EXIT;
+            break;
+        }
+        entry = jit->entries[op - code->ops];
+        if (entry == NULL && !jit->failed) entry = jit_translate(jit, (uint32_t)(op - code->ops));
+        /* Chain the direct branch exited from to this block. */
+        if (site != NULL && entry != NULL && generation == jit->generation &&
+            jit_protect(jit, site + 1 - jit->base, site + 5 - jit->base, JIT_PROT_WRITE) == 0) {
+            jit_patch_rel32(site + 1, entry);
+            (void)jit_protect(jit, site + 1 - jit->base, site + 5 - jit->base, JIT_PROT_EXEC);
+        }
+        site = NULL;
+        /* Without a usable code cache, run the threaded code. */
+        if (jit->failed) entry = NULL;
+
+        if (entry != NULL) {
+            budget = max_steps == 0 ? UINT64_MAX: (uint64_t)(max_steps - steps);
+            state.budget = budget;
+            state.stop_pc = stop_pc;
+            state.site = NULL;
+            generation = jit->generation;
+            reason = jit->enter(&context->cpu, context, &state, entry);
+            steps += (MDI_size_t)(budget - state.budget);
+        } else {
+            reason = JIT_EXIT_FALLBACK;
+        }
+
+        if (reason == JIT_EXIT_NEXT) {
+            site = state.site;
+            continue;
+        }
+        if (reason == JIT_EXIT_FALLBACK) {
+            stop = MDI_Execution_run_threaded((MDI_Execution_t)context, (MDI_ThreadedCode_t)code,
+                                              1, stop_pc, &run_steps);
+            steps += run_steps;
+            if (stop != MDI_EXECUTION_STOP_STEPS || steps == max_steps) break;
+            continue;
+        }
+        stop = reason == JIT_EXIT_LOOP ? MDI_EXECUTION_STOP_LOOP:
+            reason == JIT_EXIT_STOP_PC ? MDI_EXECUTION_STOP_PC:
+            reason == JIT_EXIT_STEPS ? MDI_EXECUTION_STOP_STEPS: MDI_EXECUTION_FAULT_EXECUTE;
+        break;
+    }
+    if (steps_ref != NULL) *steps_ref = steps;
+    return stop;
+}
+
+#else
+
+static jit_t *jit_init(execution_context_t *context, threaded_code_t *code)
+{
+    UNUSED(context);
+    UNUSED(code);
+    UNUSED(_executions_control);
+    return NULL;
+}
+
+static void jit_fini(jit_t *jit)
+{
+    UNUSED(jit);
+}
+
+static MDI_res_t jit_run(jit_t *jit, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref)
+{
+    UNUSED(jit);
+    UNUSED(max_steps);
+    UNUSED(stop_pc);
+    UNUSED(steps_ref);
+    return MDI_EXECUTION_FAULT_EXECUTE;
+}
+
+#endif
+
+/*
+ * Tiered run: cold operations are executed one at a time from the
+ * decode cache, while branch targets count their executions. A
+ * target reaching the threshold has its basic block promoted to
+ * threaded code. The promoted blocks hold at most a given total of
+ * operations, the least recently run ones being evicted first.
+ */
+#define TIER_BLOCK_MAX 64
+#define TIER_TABLE_MIN 256
+
+static uint32_t tier_hash(uint32_t pc)
+{
+    return pc * 2654435761u;
+}
+
+static tier_entry_t *tier_insert(tier_entry_t *entries, uint32_t mask, uint32_t pc)
+{
+    uint32_t idx;
+
+    for (idx = tier_hash(pc) & mask; entries[idx].valid && entries[idx].pc != pc; idx = (idx + 1) & mask);
+    return &entries[idx];
+}
+
+static int tier_resize(tier_table_t *tiers, uint32_t capacity)
+{
+    tier_entry_t *entries, *entry;
+    uint32_t i;
+
+    entries = (tier_entry_t *)calloc(capacity, sizeof(tier_entry_t));
+    if (entries == NULL) return -1;
+    for (i = 0; tiers->entries != NULL && i <= tiers->mask; i++) {
+        if (!tiers->entries[i].valid) continue;
+        entry = tier_insert(entries, capacity - 1, tiers->entries[i].pc);
+        *entry = tiers->entries[i];
+    }
+    free(tiers->entries);
+    tiers->entries = entries;
+    tiers->mask = capacity - 1;
+    return 0;
+}
+
+/*
+ * Returns the entry for pc, created if create is set, NULL if not
+ * found or on allocation failure.
+ */
+static tier_entry_t *tier_find(tier_table_t *tiers, uint32_t pc, int create)
+{
+    tier_entry_t *entry;
+
+    if (tiers->entries == NULL) {
+        if (!create || tier_resize(tiers, TIER_TABLE_MIN) != 0) return NULL;
+    }
+    entry = tier_insert(tiers->entries, tiers->mask, pc);
+    if (entry->valid) return entry;
+    if (!create) return NULL;
+    if ((tiers->count + 1) * 2 > tiers->mask + 1) {
+        if (tier_resize(tiers, (tiers->mask + 1) * 2) != 0) return NULL;
+        entry = tier_insert(tiers->entries, tiers->mask, pc);
+    }
+    entry->valid = 1;
+    entry->pc = pc;
+    tiers->count++;
+    return entry;
+}
+
+/* Evicts the least recently run block, returns -1 if none. */
+static int tier_evict(tier_table_t *tiers)
+{
+    tier_entry_t *entry, *lru = NULL;
+    uint32_t i;
+
+    for (i = 0; tiers->entries != NULL && i <= tiers->mask; i++) {
+        entry = &tiers->entries[i];
+        if (entry->valid && entry->code != NULL && (lru == NULL || entry->last_run < lru->last_run))
+            lru = entry;
+    }
+    if (lru == NULL) return -1;
+    MDI_ThreadedCode_fini(&lru->code);
+    tiers->cached_ops -= lru->opcount;
+    lru->opcount = 0;
+    lru->count = 0;
+    return 0;
+}
+
+static void tier_release(tier_table_t *tiers)
+{
+    uint32_t i;
+
+    for (i = 0; tiers->entries != NULL && i <= tiers->mask; i++) {
+        if (tiers->entries[i].code != NULL) MDI_ThreadedCode_fini(&tiers->entries[i].code);
+    }
+    free(tiers->entries);
+    tiers->entries = NULL;
+    tiers->mask = 0;
+    tiers->count = 0;
+    tiers->cached_ops = 0;
+    tiers->clock = 0;
+}
+
+/*
+ * Translates the basic block at entry pc into threaded code, up to
+ * its first control operation.
+ */
+static MDI_res_t tier_promote(execution_context_t *context, tier_entry_t *entry, MDI_ptr_t buffer, MDI_size_t size)
+{
+    tier_table_t *tiers = &context->run_tiers;
+    MDI_Operation_t operations[TIER_BLOCK_MAX];
+    MDI_ptr_t current;
+    size_t opcode_idx;
+    uint32_t i, count = 0;
+    MDI_res_t res = -1;
+
+    if (entry->pc >= (uint64_t)size) return -1;
+    current = (const char *)buffer + entry->pc;
+    while (count < TIER_BLOCK_MAX && (const char *)current < (const char *)buffer + size) {
+        operations[count] = MDI_Decoder_decode(context->run_decoder, buffer, size, &current);
+        if (operations[count] == NULL) break;
+        opcode_idx = (size_t)(intptr_t)MDI_Operator_opcode(MDI_Operation_operator(operations[count]),
+                                                           context->processor);
+        count++;
+        if (_executions_control[opcode_idx]) break;
+    }
+    if (count == 0 || count > context->tier_cache) goto end;
+    while (tiers->cached_ops + count > context->tier_cache) {
+        if (tier_evict(tiers) != 0) goto end;
+    }
+    if (MDI_ThreadedCode_init(&entry->code, (MDI_Execution_t)context, operations, count, NULL) != 0) goto end;
+    entry->opcount = count;
+    tiers->cached_ops += count;
+    res = 0;
+ end:
+    for (i = 0; i < count; i++) MDI_Operation_fini(&operations[i]);
+    return res;
+}
+
+/*
+ * Returns the threaded code of the block at the current PC, counting
+ * its execution when reached by a branch, NULL if not promoted.
+ */
+static MDI_ThreadedCode_t tier_code(execution_context_t *context, MDI_ptr_t buffer, MDI_size_t size, int branched)
+{
+    tier_table_t *tiers = &context->run_tiers;
+    tier_entry_t *entry;
+
+    entry = tier_find(tiers, context->cpu.PC[0], branched);
+    if (entry == NULL) return NULL;
+    if (entry->code == NULL && branched && ++entry->count >= context->tier_threshold) {
+        /* Count again from 0 if the block can not be promoted. */
+        if (tier_promote(context, entry, buffer, size) != 0) entry->count = 0;
+    }
+    if (entry->code != NULL) entry->last_run = ++tiers->clock;
+    return entry->code;
+}
+
+/*
+ * Code buffer run: the buffer Operations decodable from its start are
+ * translated once into threaded code, other locations are decoded
+ * and executed one at a time through a decode cache.
+ */
+static void run_release(execution_context_t *context)
+{
+    if (context->run_jit != NULL) jit_fini(context->run_jit);
+    context->run_jit = NULL;
+    tier_release(&context->run_tiers);
+    if (context->run_code != NULL) MDI_ThreadedCode_fini(&context->run_code);
+    if (context->run_cache != NULL) MDI_DecodeCache_fini(&context->run_cache);
+    if (context->run_decoder != NULL) MDI_Decoder_fini(&context->run_decoder);
+    context->run_buffer = NULL;
+    context->run_size = 0;
+}
+
+static MDI_res_t run_translate(execution_context_t *context, MDI_ptr_t buffer, MDI_size_t size)
+{
+    MDI_res_t res = -1;
+    MDI_Program_t program = NULL;
+
+    run_release(context);
+    if (MDI_Decoder_init(&context->run_decoder, context->interface, context->processor, NULL) != 0) goto end;
+    /* A predecoded file only avoids parsing, decode normally on failure. */
+    if (context->run_predecode != NULL)
+        (void)MDI_Decoder_predecode(context->run_decoder, buffer, size, context->run_predecode);
+    if (MDI_DecodeCache_init(&context->run_cache, context->run_decoder, 0, NULL) != 0) goto end;
+    /* Tiered run translates blocks when they get hot. */
+    if (context->tiered) goto translated;
+    if (MDI_Program_init(&program, context->run_decoder, buffer, size, NULL) != 0) goto end;
+    if (MDI_ThreadedCode_init_program(&context->run_code, (MDI_Execution_t)context, program, NULL) != 0) goto end;
+    /* Without JIT support, run the threaded code. */
+    if (context->jit) {
+        context->run_jit = jit_init(context, (threaded_code_t *)context->run_code);
+        if (context->run_jit == NULL && context->verbose)
+            fprintf(stderr, "mini: JIT engine not available, running threaded code\n");
+    }
+
+ translated:
+    context->run_buffer = buffer;
+    context->run_size = size;
+    res = 0;
+ end:
+    if (program != NULL) MDI_Program_fini(&program);
+    if (res != 0) run_release(context);
+    return res;
+}
+
+MDI_res_t MDI_Execution_set_predecode(MDI_Execution_t self, MDI_str_t fname)
+{
+    execution_context_t *context;
+    char *copy = NULL;
+
+    assert(self != NULL);
+    context = (execution_context_t *)self;
+
+    if (fname != NULL) {
+        copy = strdup(fname);
+        if (copy == NULL) return -1;
+    }
+    free(context->run_predecode);
+    context->run_predecode = copy;
+    run_release(context);
+    return 0;
+}
+
+MDI_res_t MDI_Execution_run(MDI_Execution_t self, MDI_ptr_t buffer, MDI_size_t size, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref)
+{
+    execution_context_t *context;
+    MDI_Operation_t operation;
+    MDI_ThreadedCode_t code;
+    mini_binding_t *binding;
+    MDI_ptr_t current;
+    MDI_size_t steps = 0, run_steps;
+    MDI_size_t pc, next_pc;
+    MDI_res_t stop;
+    int32_t res;
+    int branched = 1;
+
+    assert(self != NULL);
+    assert(buffer != NULL);
+    context = (execution_context_t *)self;
+
+    if (context->run_buffer != buffer || context->run_size != size) {
+        if (run_translate(context, buffer, size) != 0) {
+            stop = MDI_EXECUTION_FAULT_DECODE;
+            goto run_end;
+        }
+    }
+
+    while (1) {
+        code = context->tiered ? tier_code(context, buffer, size, branched): context->run_code;
+        if (context->run_jit != NULL) {
+            stop = jit_run(context->run_jit, max_steps == 0 ? 0: max_steps - steps, stop_pc, &run_steps);
+        } else if (code != NULL) {
+            stop = MDI_Execution_run_threaded(self, code, max_steps == 0 ? 0: max_steps - steps,
+                                              stop_pc, &run_steps);
+        } else {
+            stop = MDI_EXECUTION_STOP_EXIT;
+            run_steps = 0;
+        }
+        steps += run_steps;
+        if (stop != MDI_EXECUTION_STOP_EXIT) break;
+        /* Out of a promoted block, look for the next one. */
+        if (context->tiered && code != NULL) {
+            branched = 1;
+            continue;
+        }
+
+        /* Outside of the threaded code, execute one Operation. */
+        pc = (MDI_size_t)context->cpu.PC[0];
+        if (pc < 0 || pc >= size) {
+            stop = MDI_EXECUTION_FAULT_DECODE;
+            break;
+        }
+        current = (const char *)buffer + pc;
+        operation = MDI_DecodeCache_decode(context->run_cache, buffer, size, &current);
+        if (operation == NULL) {
+            stop = MDI_EXECUTION_FAULT_DECODE;
+            break;
+        }
+        binding = execution_bind(context, operation);
+        res = ((EXE_FUNC_T)binding->handler)(context, binding->operands, binding->op_size);
+        next_pc = (MDI_size_t)context->cpu.PC[0];
+        steps++;
+        if (res != 0) { stop = MDI_EXECUTION_FAULT_EXECUTE; break; }
+        if (next_pc == pc) { stop = MDI_EXECUTION_STOP_LOOP; break; }
+        if (next_pc == stop_pc) { stop = MDI_EXECUTION_STOP_PC; break; }
+        if (steps == max_steps) { stop = MDI_EXECUTION_STOP_STEPS; break; }
+        branched = next_pc != pc + binding->op_size;
+    }
+
+ run_end:
+    if (steps_ref != NULL) *steps_ref = steps;
+    return stop;
+}
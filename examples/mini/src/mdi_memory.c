@@ -0,0 +1,205 @@
+/*
+ * Memory Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#include "mdi_memory.h"
+
+/* No page index reaches it given MINI_MEMORY_PAGE_SIZE_MIN. */
+#define LAST_INDEX_NONE UINT32_MAX
+
+static uint32_t log2_ceil(uint64_t value)
+{
+    uint32_t bits = 0;
+    while (((uint64_t)1 << bits) < value) bits++;
+    return bits;
+}
+
+static char *memory_page_alloc(mini_memory_t mem)
+{
+    size_t page_size = (size_t)1 << mem->page_bits;
+#if defined(MADV_HUGEPAGE)
+    if (mem->huge) {
+        /* Over map for the alignment required by huge pages. */
+        char *map, *page;
+        size_t head;
+        map = (char *)mmap(NULL, 2 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED) return NULL;
+        head = (page_size - ((uintptr_t)map & (page_size - 1))) & (page_size - 1);
+        page = map + head;
+        if (head > 0) munmap(map, head);
+        munmap(page + page_size, page_size - head);
+        madvise(page, page_size, MADV_HUGEPAGE);
+        return page;
+    }
+#endif
+    return (char *)calloc(page_size, sizeof(char));
+}
+
+static void memory_page_free(mini_memory_t mem, char *page)
+{
+#if defined(MADV_HUGEPAGE)
+    if (mem->huge) {
+        munmap(page, (size_t)1 << mem->page_bits);
+        return;
+    }
+#endif
+    free(page);
+}
+
+/*
+ * Returns the page holding addr, allocating it if allocate is set,
+ * or NULL if not allocated. The page becomes the last accessed one.
+ */
+static char *memory_page(mini_memory_t mem, uint32_t addr, int allocate)
+{
+    uint32_t index = addr >> mem->page_bits;
+    uint32_t entry = index & ((UINT32_C(1) << mem->table_bits) - 1);
+    char **table = mem->tables[index >> mem->table_bits];
+    char *page;
+
+    if (table == NULL) {
+        if (!allocate) return NULL;
+        table = (char **)calloc((size_t)1 << mem->table_bits, sizeof(char *));
+        if (table == NULL) return NULL;
+        mem->tables[index >> mem->table_bits] = table;
+    }
+    page = table[entry];
+    if (page == NULL) {
+        if (!allocate) return NULL;
+        page = memory_page_alloc(mem);
+        if (page == NULL) return NULL;
+        table[entry] = page;
+    }
+    mem->last_index = index;
+    mem->last_page = page;
+    return page;
+}
+
+int mini_memory_init(mini_memory_t *mem_ref, uint64_t size, uint64_t page_size)
+{
+    mini_memory_t mem;
+    uint64_t pages;
+
+    assert(mem_ref != NULL);
+    *mem_ref = NULL;
+    if (size < sizeof(uint32_t) || size > MINI_MEMORY_SIZE_MAX) return -1;
+    if (page_size < MINI_MEMORY_PAGE_SIZE_MIN || page_size > MINI_MEMORY_PAGE_SIZE_MAX ||
+        (page_size & (page_size - 1)) != 0) return -1;
+
+    mem = (mini_memory_t)calloc(1, sizeof(mini_memory_state_t));
+    if (mem == NULL) return -1;
+    mem->size = size;
+    mem->limit = (uint32_t)(size - sizeof(uint32_t));
+    mem->page_bits = log2_ceil(page_size);
+    mem->page_mask = (uint32_t)(page_size - 1);
+    /* Balance the two levels, 1024 tables of 1024 pages for 4 GiB of 4 KiB pages. */
+    pages = (size + page_size - 1) >> mem->page_bits;
+    mem->table_bits = (log2_ceil(pages) + 1) / 2;
+    mem->tables_count = (uint32_t)(((pages - 1) >> mem->table_bits) + 1);
+    mem->tables = (char ***)calloc(mem->tables_count, sizeof(char **));
+    if (mem->tables == NULL) {
+        free(mem);
+        return -1;
+    }
+#if defined(MADV_HUGEPAGE)
+    mem->huge = page_size >= MINI_MEMORY_HUGE_PAGE_SIZE;
+#endif
+    mem->last_index = LAST_INDEX_NONE;
+    *mem_ref = mem;
+    return 0;
+}
+
+void mini_memory_fini(mini_memory_t *mem_ref)
+{
+    mini_memory_t mem;
+    uint32_t t, p;
+
+    assert(mem_ref != NULL);
+    mem = *mem_ref;
+    if (mem == NULL) return;
+    for (t = 0; t < mem->tables_count; t++) {
+        if (mem->tables[t] == NULL) continue;
+        for (p = 0; p < (UINT32_C(1) << mem->table_bits); p++) {
+            if (mem->tables[t][p] != NULL) memory_page_free(mem, mem->tables[t][p]);
+        }
+        free(mem->tables[t]);
+    }
+    free(mem->tables);
+    free(mem);
+    *mem_ref = NULL;
+}
+
+uint32_t mini_memory_read32_slow(mini_memory_t mem, uint32_t addr)
+{
+    unsigned char bytes[sizeof(uint32_t)];
+    const char *page;
+    uint32_t value, i;
+
+    if (addr > mem->limit) {
+        mem->fault = 1;
+        return 0;
+    }
+    /* Bytes of pages not allocated read as zero. */
+    for (i = 0; i < sizeof(bytes); i++) {
+        page = memory_page(mem, addr + i, 0);
+        bytes[i] = page == NULL ? 0: page[(addr + i) & mem->page_mask];
+    }
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+void mini_memory_write32_slow(mini_memory_t mem, uint32_t addr, uint32_t value)
+{
+    unsigned char bytes[sizeof(uint32_t)];
+    char *pages[sizeof(uint32_t)];
+    uint32_t i;
+
+    if (addr > mem->limit) {
+        mem->fault = 1;
+        return;
+    }
+    /* Allocate all touched pages first for the write to be all or nothing. */
+    for (i = 0; i < sizeof(bytes); i++) {
+        pages[i] = memory_page(mem, addr + i, 1);
+        if (pages[i] == NULL) {
+            mem->fault = 1;
+            return;
+        }
+    }
+    memcpy(bytes, &value, sizeof(bytes));
+    for (i = 0; i < sizeof(bytes); i++) {
+        pages[i][(addr + i) & mem->page_mask] = bytes[i];
+    }
+}
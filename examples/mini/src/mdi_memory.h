@@ -0,0 +1,134 @@
+/*
+ * Memory Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef MDI_MINI_MEMORY_H
+#define MDI_MINI_MEMORY_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Guest memory of the MINI processor, a 32 bits byte addressed space
+ * of size bytes from address 0.
+ * Memory is held by a sparse two levels page table, pages are
+ * allocated on first write and read as zero before, thus a large
+ * space costs only the touched pages.
+ * Pages of at least MINI_MEMORY_HUGE_PAGE_SIZE bytes are requested
+ * as transparent huge pages where available.
+ */
+#define MINI_MEMORY_SIZE 4096
+#define MINI_MEMORY_SIZE_MAX ((uint64_t)1 << 32)
+#define MINI_MEMORY_PAGE_SIZE 4096
+#define MINI_MEMORY_PAGE_SIZE_MIN 16
+#define MINI_MEMORY_PAGE_SIZE_MAX ((uint64_t)1 << 30)
+#define MINI_MEMORY_HUGE_PAGE_SIZE ((uint64_t)2 << 20)
+
+typedef struct {
+    uint64_t size;
+    uint32_t limit;         /* Last valid address of a 32 bits access. */
+    uint32_t page_bits;
+    uint32_t page_mask;
+    uint32_t table_bits;    /* Pages per table, log2. */
+    uint32_t tables_count;
+    char ***tables;
+    int huge;
+    int fault;
+    /* Last accessed allocated page. */
+    uint32_t last_index;
+    char *last_page;
+} mini_memory_state_t;
+
+typedef mini_memory_state_t *mini_memory_t;
+
+/*
+ * Allocates in mem_ref a memory of size bytes with pages of page_size
+ * bytes. Size must be in [4, MINI_MEMORY_SIZE_MAX], page_size a power
+ * of 2 in [MINI_MEMORY_PAGE_SIZE_MIN, MINI_MEMORY_PAGE_SIZE_MAX].
+ * Returns 0 on success.
+ */
+extern int mini_memory_init(mini_memory_t *mem_ref, uint64_t size, uint64_t page_size);
+
+/*
+ * Releases the memory and its pages.
+ */
+extern void mini_memory_fini(mini_memory_t *mem_ref);
+
+/*
+ * Out of line accesses for the page crossing, not last accessed or out
+ * of bounds cases, see below.
+ */
+extern uint32_t mini_memory_read32_slow(mini_memory_t mem, uint32_t addr);
+extern void mini_memory_write32_slow(mini_memory_t mem, uint32_t addr, uint32_t value);
+
+#define MINI_MEMORY_LAST(mem, addr) \
+    ((addr) <= (mem)->limit && ((addr) >> (mem)->page_bits) == (mem)->last_index && \
+     ((addr) & (mem)->page_mask) <= (mem)->page_mask - 3)
+
+/*
+ * Reads the 32 bits word at addr in host byte order.
+ * Out of bounds accesses read 0 and record a fault, see
+ * mini_memory_status().
+ */
+static inline uint32_t mini_memory_read32(mini_memory_t mem, uint32_t addr)
+{
+    uint32_t value;
+    if (MINI_MEMORY_LAST(mem, addr)) {
+        memcpy(&value, mem->last_page + (addr & mem->page_mask), sizeof(value));
+        return value;
+    }
+    return mini_memory_read32_slow(mem, addr);
+}
+
+/*
+ * Writes the 32 bits word at addr in host byte order.
+ * Out of bounds accesses, or a failed page allocation, are ignored
+ * and record a fault, see mini_memory_status().
+ */
+static inline void mini_memory_write32(mini_memory_t mem, uint32_t addr, uint32_t value)
+{
+    if (MINI_MEMORY_LAST(mem, addr)) {
+        memcpy(mem->last_page + (addr & mem->page_mask), &value, sizeof(value));
+        return;
+    }
+    mini_memory_write32_slow(mem, addr, value);
+}
+
+/*
+ * Returns -1 and clears the fault if an access faulted since the last
+ * call, 0 otherwise.
+ */
+static inline int mini_memory_status(mini_memory_t mem)
+{
+    if (mem->fault == 0) return 0;
+    mem->fault = 0;
+    return -1;
+}
+
+#endif
@@ -29,17 +29,23 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <MDI/mdi.h>
 #include <MDI/mdi_operations.h>
+#include "mdi_operation.h"
 
 #define UNUSED(var) ((void)(var))
 
+/* The decode info is held inline by an operation and not owned. */
+#define DECODE_INFO_INLINE 1
+
 typedef struct {
     intptr_t buffer;
     size_t offset;
     size_t size;
+    uint32_t flags;
 } decode_info_t;
 
 typedef struct {
@@ -49,35 +55,95 @@ typedef struct {
     size_t size;
 } assemble_info_t;
 
+/* The operation storage is owned and released on fini. */
+#define OPERATION_OWNED 1
+
+/*
+ * Operands are held inline for up to OPERANDS_INLINE operands,
+ * larger operands lists spill after the operation_t in the same
+ * storage, such that a single allocation, or none for client
+ * provided storages, is necessary.
+ */
+#define OPERANDS_INLINE 4
+
 typedef struct {
+    mini_binding_t binding;
     uint32_t operator;
     uint32_t opcount;
-    intptr_t *operands;
-    uint32_t opsize;
+    uint32_t flags;
     decode_info_t *decode_info;
     assemble_info_t *parse_info;
+    decode_info_t inline_decode_info;
+    intptr_t inline_operands[OPERANDS_INLINE];
 } operation_t;
 
-MDI_res_t MDI_Operation_init(MDI_Operation_t *self_ref, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params)
+#define OPERATION_OPERANDS(operation) \
+    ((operation)->opcount <= OPERANDS_INLINE ? (operation)->inline_operands: (intptr_t *)((operation) + 1))
+
+typedef struct {
+    char c;
+    operation_t operation;
+} operation_align_t;
+
+MDI_size_t MDI_Operation_storage_size(MDI_size_t opcount)
+{
+    assert(opcount >= 0);
+    if (opcount <= OPERANDS_INLINE) return (MDI_size_t)sizeof(operation_t);
+    return (MDI_size_t)(sizeof(operation_t) + opcount * sizeof(intptr_t));
+}
+
+MDI_size_t MDI_Operation_storage_align(void)
+{
+    return (MDI_size_t)offsetof(operation_align_t, operation);
+}
+
+MDI_res_t MDI_Operation_init_storage(MDI_Operation_t *self_ref, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params)
 {
     operation_t *operation;
+    intptr_t *operation_operands;
     int i;
     assert(self_ref != NULL);
+    assert(storage != NULL);
+    assert((intptr_t)storage % MDI_Operation_storage_align() == 0);
     UNUSED(params);
-    operation = (operation_t *)calloc(1, sizeof(operation_t));
+    if (storage_size < MDI_Operation_storage_size(opcount)) return -1;
+
+    operation = (operation_t *)storage;
+    operation->binding.key = NULL;
     operation->operator = (uint32_t)(intptr_t)operator;
     operation->opcount = opcount;
-    if (opcount > 0) {
-        operation->operands = (intptr_t *)calloc(opcount, sizeof(intptr_t));
-    }
+    operation->flags = 0;
+    operation->decode_info = NULL;
+    operation->parse_info = NULL;
 
+    operation_operands = OPERATION_OPERANDS(operation);
     for (i = 0; i < opcount; i++) {
-        operation->operands[i] = ((intptr_t *)operands)[i];
+        operation_operands[i] = ((intptr_t *)operands)[i];
     }
     *self_ref = operation;
     return 0;
 }
 
+MDI_res_t MDI_Operation_init(MDI_Operation_t *self_ref, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params)
+{
+    operation_t *operation;
+    MDI_size_t storage_size;
+    MDI_res_t res;
+    assert(self_ref != NULL);
+
+    storage_size = MDI_Operation_storage_size(opcount);
+    operation = (operation_t *)malloc(storage_size);
+    if (operation == NULL) return -1;
+
+    res = MDI_Operation_init_storage(self_ref, (MDI_ptr_mut_t)operation, storage_size, operator, opcount, operands, params);
+    if (res != 0) {
+        free(operation);
+        return res;
+    }
+    operation->flags |= OPERATION_OWNED;
+    return 0;
+}
+
 MDI_res_t MDI_Operation_fini(MDI_Operation_t *self_ref)
 {
     operation_t *operation;
@@ -86,11 +152,9 @@ MDI_res_t MDI_Operation_fini(MDI_Operation_t *self_ref)
     operation = (operation_t *)*self_ref;
     if (operation == NULL) return -1;
 
-    if (operation->opcount > 0) {
-        free(operation->operands);
-        operation->operands = NULL;
+    if (operation->flags & OPERATION_OWNED) {
+        free(operation);
     }
-    free(operation);
     *self_ref = NULL;
     return 0;
 }
@@ -112,7 +176,7 @@ MDI_ptr_t MDI_Operation_operands(MDI_Operation_t self)
     assert(self != NULL);
     operation = (operation_t *)self;
     
-    return (MDI_ptr_t)operation->operands;
+    return (MDI_ptr_t)OPERATION_OPERANDS(operation);
 }
 
 MDI_size_t MDI_Operation_opcount(MDI_Operation_t self)
@@ -142,9 +206,30 @@ void MDI_Operation_set_decode_info(MDI_Operation_t self, MDI_DecodeInfo_t decode
     assert(self != NULL);
     operation = (operation_t *)self;
     
+    operation->binding.key = NULL;
     operation->decode_info = (decode_info_t *)decode_info;
 }
 
+MDI_res_t MDI_Operation_init_decode_info(MDI_Operation_t self, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size, MDI_object_t params)
+{
+    operation_t *operation;
+    decode_info_t *decode_info;
+
+    assert(self != NULL);
+    UNUSED(params);
+    operation = (operation_t *)self;
+
+    decode_info = &operation->inline_decode_info;
+    decode_info->buffer = (intptr_t)buffer;
+    decode_info->offset = offset;
+    decode_info->size = size;
+    decode_info->flags = DECODE_INFO_INLINE;
+
+    operation->binding.key = NULL;
+    operation->decode_info = decode_info;
+    return 0;
+}
+
 MDI_res_t MDI_DecodeInfo_init(MDI_DecodeInfo_t *self_ref, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size, MDI_object_t params)
 {
     decode_info_t *decode_info;
@@ -169,7 +254,9 @@ MDI_INTERFACE MDI_res_t MDI_DecodeInfo_fini(MDI_DecodeInfo_t *self_ref)
     decode_info = (decode_info_t *)*self_ref;
     if (decode_info == NULL) return -1;
     
-    free(decode_info);
+    if (!(decode_info->flags & DECODE_INFO_INLINE)) {
+        free(decode_info);
+    }
     *self_ref = NULL;
     return 0;
 }
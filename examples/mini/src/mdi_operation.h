@@ -0,0 +1,57 @@
+/*
+ * Operation private interface for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef MDI_MINI_OPERATION_H
+#define MDI_MINI_OPERATION_H
+
+#include <stdint.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+
+/*
+ * Binding of an Operation to an execution handler, see
+ * MDI_Execution_bind(). The key identifies the handlers table the
+ * handler was resolved from, a NULL key means unbound, and processor
+ * the Processor the opcode was resolved for.
+ * The binding is the first member of every MINI Operation, hence an
+ * Operation can be used as a mini_binding_t pointer. It is reset
+ * when the Operation is constructed or its DecodeInfo changes.
+ */
+typedef struct {
+    const void *key;
+    MDI_Processor_t processor;
+    void (*handler)(void);
+    const intptr_t *operands;
+    uint32_t op_size;
+} mini_binding_t;
+
+#define MINI_OPERATION_BINDING(operation) ((mini_binding_t *)(operation))
+
+#endif
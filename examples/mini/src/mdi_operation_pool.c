@@ -0,0 +1,172 @@
+/*
+ * Operation Pool Interface Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+
+#define UNUSED(var) ((void)(var))
+
+#define CHUNK_SIZE_DEFAULT (64 * 1024)
+
+/*
+ * The pool is a list of chunks with a bump pointer into the
+ * current chunk. Chunks are kept on reset and reused in order
+ * by subsequent allocations, thus reset is O(1) and a pool
+ * in steady state does not allocate.
+ */
+typedef struct chunk_s {
+    struct chunk_s *next;
+    size_t size;
+    /* Followed by size bytes of storage. */
+} chunk_t;
+
+typedef struct {
+    size_t chunk_size;
+    chunk_t *first;
+    chunk_t *current;
+    char *ptr;
+    char *limit;
+} operation_pool_t;
+
+#define CHUNK_DATA(chunk) ((char *)((chunk) + 1))
+
+MDI_res_t MDI_OperationPool_init(MDI_OperationPool_t *self_ref, MDI_size_t chunk_size, MDI_object_t params)
+{
+    operation_pool_t *pool;
+
+    assert(self_ref != NULL);
+    assert(chunk_size >= 0);
+    UNUSED(params);
+
+    pool = (operation_pool_t *)calloc(1, sizeof(operation_pool_t));
+    if (pool == NULL) return -1;
+    pool->chunk_size = chunk_size > 0 ? chunk_size: CHUNK_SIZE_DEFAULT;
+
+    *self_ref = (MDI_OperationPool_t)pool;
+    return 0;
+}
+
+MDI_res_t MDI_OperationPool_fini(MDI_OperationPool_t *self_ref)
+{
+    operation_pool_t *pool;
+    chunk_t *chunk, *next;
+
+    assert(self_ref != NULL);
+    pool = (operation_pool_t *)*self_ref;
+    if (pool == NULL) return -1;
+
+    for (chunk = pool->first; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+    free(pool);
+    *self_ref = NULL;
+    return 0;
+}
+
+void MDI_OperationPool_reset(MDI_OperationPool_t self)
+{
+    operation_pool_t *pool;
+
+    assert(self != NULL);
+    pool = (operation_pool_t *)self;
+
+    pool->current = pool->first;
+    if (pool->current != NULL) {
+        pool->ptr = CHUNK_DATA(pool->current);
+        pool->limit = pool->ptr + pool->current->size;
+    }
+}
+
+static char *align_ptr(char *ptr, size_t align)
+{
+    return (char *)(((uintptr_t)ptr + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+MDI_ptr_mut_t MDI_OperationPool_alloc(MDI_OperationPool_t self, MDI_size_t size, MDI_size_t align)
+{
+    operation_pool_t *pool;
+    chunk_t *chunk;
+    size_t chunk_size;
+    char *ptr;
+
+    assert(self != NULL);
+    assert(size >= 0);
+    assert(align > 0 && (align & (align - 1)) == 0);
+    pool = (operation_pool_t *)self;
+
+    if (pool->current != NULL) {
+        ptr = align_ptr(pool->ptr, align);
+        if (ptr <= pool->limit && size <= pool->limit - ptr) {
+            pool->ptr = ptr + size;
+            return (MDI_ptr_mut_t)ptr;
+        }
+    }
+
+    /* Move to the next kept chunk if large enough, otherwise insert a new one. */
+    chunk = pool->current != NULL ? pool->current->next: pool->first;
+    if (chunk == NULL || chunk->size < size + align) {
+        chunk_size = pool->chunk_size;
+        if (chunk_size < size + align) chunk_size = size + align;
+        chunk = (chunk_t *)malloc(sizeof(chunk_t) + chunk_size);
+        if (chunk == NULL) return NULL;
+        chunk->size = chunk_size;
+        if (pool->current != NULL) {
+            chunk->next = pool->current->next;
+            pool->current->next = chunk;
+        } else {
+            chunk->next = pool->first;
+            pool->first = chunk;
+        }
+    }
+    pool->current = chunk;
+    pool->limit = CHUNK_DATA(chunk) + chunk->size;
+    ptr = align_ptr(CHUNK_DATA(chunk), align);
+    pool->ptr = ptr + size;
+    return (MDI_ptr_mut_t)ptr;
+}
+
+MDI_res_t MDI_Operation_init_pool(MDI_Operation_t *self_ref, MDI_OperationPool_t pool, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params)
+{
+    MDI_ptr_mut_t storage;
+    MDI_size_t storage_size;
+
+    assert(self_ref != NULL);
+    assert(pool != NULL);
+
+    storage_size = MDI_Operation_storage_size(opcount);
+    storage = MDI_OperationPool_alloc(pool, storage_size, MDI_Operation_storage_align());
+    if (storage == NULL) return -1;
+
+    return MDI_Operation_init_storage(self_ref, storage, storage_size, operator, opcount, operands, params);
+}
@@ -0,0 +1,107 @@
+/*
+ * Parameters Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <MDI/mdi.h>
+#include "mdi_params.h"
+
+static const char *params_string(MDI_object_t params)
+{
+    const char *string = (const char *)params;
+    if (string == NULL) string = getenv(MINI_PARAMS_ENV);
+    return string == NULL ? "": string;
+}
+
+int mini_params_get(MDI_object_t params, const char *name, const char **value_ref, size_t *len_ref)
+{
+    const char *current = params_string(params);
+    const char *option, *value;
+    size_t name_len = strlen(name);
+    size_t option_len, value_len;
+    int found = 0;
+
+    while (*current != '\0') {
+        current += strspn(current, " \t");
+        option = current;
+        current += strcspn(current, " \t");
+        option_len = current - option;
+        if (option_len < name_len || strncmp(option, name, name_len) != 0) continue;
+        if (option_len == name_len) {
+            value = option + option_len;
+            value_len = 0;
+        } else if (option[name_len] == '=') {
+            value = option + name_len + 1;
+            value_len = option_len - name_len - 1;
+        } else {
+            continue;
+        }
+        if (value_ref != NULL) *value_ref = value;
+        if (len_ref != NULL) *len_ref = value_len;
+        found = 1;
+    }
+    return found;
+}
+
+int mini_params_is(MDI_object_t params, const char *name, const char *value)
+{
+    const char *found;
+    size_t len;
+
+    if (!mini_params_get(params, name, &found, &len)) return 0;
+    return len == strlen(value) && strncmp(found, value, len) == 0;
+}
+
+int mini_params_uint(MDI_object_t params, const char *name, uint64_t default_value, uint64_t *value_ref)
+{
+    const char *found;
+    char string[32], *end;
+    unsigned long long value;
+    unsigned shift = 0;
+    size_t len;
+
+    *value_ref = default_value;
+    if (!mini_params_get(params, name, &found, &len)) return 0;
+    if (len == 0 || len >= sizeof(string) || found[0] < '0' || found[0] > '9') return -1;
+    memcpy(string, found, len);
+    string[len] = '\0';
+    errno = 0;
+    value = strtoull(string, &end, 0);
+    if (end == string || errno == ERANGE) return -1;
+    switch (*end) {
+    case 'K': shift = 10; end++; break;
+    case 'M': shift = 20; end++; break;
+    case 'G': shift = 30; end++; break;
+    }
+    if (*end != '\0' || value > (UINT64_MAX >> shift)) return -1;
+    *value_ref = (uint64_t)value << shift;
+    return 0;
+}
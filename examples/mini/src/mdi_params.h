@@ -0,0 +1,69 @@
+/*
+ * Parameters Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef MDI_MINI_PARAMS_H
+#define MDI_MINI_PARAMS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <MDI/mdi.h>
+
+/*
+ * The MINI implementation accepts as MDI_object_t params a C string
+ * of space separated options, each either "name" or "name=value".
+ * When params is NULL, the MDI_MINI_PARAMS environment variable is
+ * used instead, if defined.
+ */
+#define MINI_PARAMS_ENV "MDI_MINI_PARAMS"
+
+/*
+ * Finds option name in params.
+ * Returns 1 if found, with the value (not nul terminated) and its
+ * length in value_ref and len_ref if not NULL, 0 otherwise.
+ * An option without value has an empty value.
+ * The last occurence of an option takes precedence.
+ */
+extern int mini_params_get(MDI_object_t params, const char *name, const char **value_ref, size_t *len_ref);
+
+/*
+ * Returns 1 if option name is given with the given value.
+ */
+extern int mini_params_is(MDI_object_t params, const char *name, const char *value);
+
+/*
+ * Gets in value_ref the unsigned value of option name, a C integer
+ * constant optionally followed by a K, M or G binary multiplier,
+ * or default_value if the option is not given.
+ * Returns 0 on success, -1 if the value is malformed or does not fit
+ * in 64 bits.
+ */
+extern int mini_params_uint(MDI_object_t params, const char *name, uint64_t default_value, uint64_t *value_ref);
+
+#endif
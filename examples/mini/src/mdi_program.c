@@ -0,0 +1,271 @@
+/*
+ * Program Implementation for MINI platform.
+ *
+ * This software is delivered under the terms of the MIT License
+ *
+ * Copyright (c) 2016 STMicroelectronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
+#include "mdi_decoder.h"
+
+#define UNUSED(var) ((void)(var))
+
+#define ALLOC_MIN 1024
+
+/*
+ * The Program arrays are indexed by Operation, the operands of
+ * the Operation idx are operands[operand_starts[idx]] to
+ * operands[operand_starts[idx + 1]] excluded.
+ */
+typedef struct {
+    MDI_interface_t mdi;
+    MDI_size_t count;
+    MDI_size_t alloc;
+    MDI_size_t size;
+    MDI_res_t stop;
+    uint16_t *operators;
+    uint32_t *offsets;
+    uint32_t *sizes;
+    uint32_t *operand_starts;
+    intptr_t *operands;
+} program_t;
+
+static int program_grow(program_t *program)
+{
+    MDI_size_t alloc;
+    void *array;
+
+    alloc = program->alloc == 0 ? ALLOC_MIN: program->alloc * 2;
+    if ((array = realloc(program->operators, alloc * sizeof(uint16_t))) == NULL) return -1;
+    program->operators = (uint16_t *)array;
+    if ((array = realloc(program->offsets, alloc * sizeof(uint32_t))) == NULL) return -1;
+    program->offsets = (uint32_t *)array;
+    if ((array = realloc(program->sizes, alloc * sizeof(uint32_t))) == NULL) return -1;
+    program->sizes = (uint32_t *)array;
+    if ((array = realloc(program->operand_starts, (alloc + 1) * sizeof(uint32_t))) == NULL) return -1;
+    program->operand_starts = (uint32_t *)array;
+    if ((array = realloc(program->operands, alloc * MINI_OPERANDS_MAX * sizeof(intptr_t))) == NULL) return -1;
+    program->operands = (intptr_t *)array;
+    program->alloc = alloc;
+    return 0;
+}
+
+static void program_free(program_t *program)
+{
+    free(program->operators);
+    free(program->offsets);
+    free(program->sizes);
+    free(program->operand_starts);
+    free(program->operands);
+    free(program);
+}
+
+MDI_res_t MDI_Program_init(MDI_Program_t *self_ref, MDI_Decoder_t decoder, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_object_t params)
+{
+    program_t *program;
+    MDI_ptr_t current, start;
+    uint32_t operands[MINI_OPERANDS_MAX];
+    uint32_t operator_idx, operand_start;
+    int num_operands, i;
+    MDI_res_t res;
+
+    assert(self_ref != NULL);
+    assert(decoder != NULL);
+    assert(buffer != NULL || buffer_size == 0);
+    assert((uint64_t)buffer_size <= UINT32_MAX);
+    UNUSED(params);
+
+    program = (program_t *)calloc(1, sizeof(program_t));
+    if (program == NULL) return -1;
+    program->mdi = mini_decoder_interface(decoder);
+    if (program_grow(program) != 0) goto error;
+    program->operand_starts[0] = 0;
+
+    /* Operations are parsed in place into the arrays, without Operation objects. */
+    current = buffer;
+    while (1) {
+        start = current;
+        res = mini_decoder_parse(decoder, buffer, buffer_size, &current, operands,
+                                 &operator_idx, &num_operands);
+        if (res != 0) break;
+        if (program->count == program->alloc && program_grow(program) != 0) goto error;
+        operand_start = program->operand_starts[program->count];
+        program->operators[program->count] = (uint16_t)operator_idx;
+        program->offsets[program->count] = (uint32_t)(start - buffer);
+        program->sizes[program->count] = (uint32_t)(current - start);
+        for (i = 0; i < num_operands; i++)
+            program->operands[operand_start + i] = (intptr_t)operands[i];
+        program->operand_starts[program->count + 1] = operand_start + num_operands;
+        program->count++;
+    }
+    program->stop = res;
+    program->size = current - buffer;
+
+    *self_ref = (MDI_Program_t)program;
+    return 0;
+ error:
+    program_free(program);
+    return -1;
+}
+
+MDI_res_t MDI_Program_fini(MDI_Program_t *self_ref)
+{
+    program_t *program;
+
+    assert(self_ref != NULL);
+    program = (program_t *)*self_ref;
+    if (program == NULL) return -1;
+
+    program_free(program);
+    *self_ref = NULL;
+    return 0;
+}
+
+MDI_size_t MDI_Program_count(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->count;
+}
+
+MDI_size_t MDI_Program_size(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->size;
+}
+
+MDI_res_t MDI_Program_stop(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->stop;
+}
+
+const uint16_t *MDI_Program_operators(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->operators;
+}
+
+const uint32_t *MDI_Program_offsets(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->offsets;
+}
+
+const uint32_t *MDI_Program_sizes(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->sizes;
+}
+
+const uint32_t *MDI_Program_operand_starts(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->operand_starts;
+}
+
+const intptr_t *MDI_Program_operands(MDI_Program_t self)
+{
+    program_t *program;
+
+    assert(self != NULL);
+    program = (program_t *)self;
+
+    return program->operands;
+}
+
+MDI_size_t MDI_Program_find(MDI_Program_t self, MDI_size_t offset)
+{
+    const program_t *program;
+    MDI_size_t low, high, idx;
+
+    assert(self != NULL);
+    program = (const program_t *)self;
+
+    if (offset < 0 || offset >= program->size) return -1;
+    low = 0;
+    high = program->count;
+    while (low < high) {
+        idx = low + (high - low) / 2;
+        if (program->offsets[idx] < (uint32_t)offset) low = idx + 1;
+        else high = idx;
+    }
+    if (low == program->count || program->offsets[low] != (uint32_t)offset) return -1;
+    return low;
+}
+
+MDI_Operation_t MDI_Program_operation(MDI_Program_t self, MDI_size_t idx, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_ptr_t buffer)
+{
+    const program_t *program;
+    MDI_Operation_t operation;
+    uint32_t operand_start;
+
+    assert(self != NULL);
+    assert(storage != NULL);
+    program = (const program_t *)self;
+    assert(idx >= 0 && idx < program->count);
+
+    operand_start = program->operand_starts[idx];
+    if (MDI_Operation_init_storage(&operation, storage, storage_size,
+                                   MDI_Operators_iter(program->mdi, program->operators[idx]),
+                                   program->operand_starts[idx + 1] - operand_start,
+                                   (MDI_ptr_t)(program->operands + operand_start), NULL) != 0)
+        return (MDI_Operation_t)NULL;
+    if (MDI_Operation_init_decode_info(operation, buffer, program->offsets[idx], program->sizes[idx], NULL) != 0)
+        return (MDI_Operation_t)NULL;
+    return operation;
+}
@@ -100,7 +100,7 @@
 /** Full revision for this interface. */
 #define MDI_VERSION_REV MDI_VERSION_MAKE_REV(MDI_VERSION_MAJOR,MDI_VERSION_MINOR,MDI_VERSION_PATCH)
 #define MDI_VERSION_MAJOR 0  /**< Major version, incompatible both way when differ. */
-#define MDI_VERSION_MINOR 2  /**< Minor version, compatible if implementation is greater. */
+#define MDI_VERSION_MINOR 3  /**< Minor version, compatible if implementation is greater. */
 #define MDI_VERSION_PATCH 0  /**< Patch version, compatible both way when differ. */
 /**@}*/
 
@@ -92,6 +92,22 @@ typedef MDI_object_t MDI_Operation_t;
 typedef MDI_object_t MDI_DecodeInfo_t;
 /**@}*/
 
+/**
+ * @defgroup MDI_OperationPool Operation pool object
+ *
+ * An abstract object for grouped allocation of Operations.
+ */
+/**@{*/
+/**
+ * @brief OperationPool object abstraction
+ *
+ * An OperationPool is an arena from which Operations can be
+ * allocated. All Operations allocated from a pool are released
+ * at once when the pool is reset or destroyed.
+ */
+typedef MDI_object_t MDI_OperationPool_t;
+/**@}*/
+
 /**
  * @defgroup MDI_Decoder Decoder object
  *
@@ -108,6 +124,41 @@ typedef MDI_object_t MDI_DecodeInfo_t;
 typedef MDI_object_t MDI_Decoder_t;
 /**@}*/
 
+/**
+ * @defgroup MDI_DecodeCache Decode cache object
+ *
+ * An abstract object for caching decoded Operations.
+ */
+/**@{*/
+/**
+ * @brief DecodeCache object abstraction
+ *
+ * A DecodeCache holds Operations decoded by a Decoder, keyed
+ * by their decode buffer and offset, such that repeated decoding
+ * at the same location, for instance when executing a loop, does not
+ * pay the decoding cost again.
+ */
+typedef MDI_object_t MDI_DecodeCache_t;
+/**@}*/
+
+/**
+ * @defgroup MDI_Program Program object
+ *
+ * An abstract object holding decoded code as arrays.
+ */
+/**@{*/
+/**
+ * @brief Program object abstraction
+ *
+ * A Program holds the Operations decoded successively from a
+ * buffer as parallel arrays indexed by Operation: Operator indexes,
+ * buffer offsets, encoded sizes and operands, such that analyses
+ * and translations stream through decoded code without an Operation
+ * object per decoded Operation.
+ */
+typedef MDI_object_t MDI_Program_t;
+/**@}*/
+
 /**
  * @defgroup MDI_Disassembler Disassembler object
  *
@@ -139,6 +190,22 @@ typedef MDI_object_t MDI_Disassembler_t;
 typedef MDI_object_t MDI_Execution_t;
 /**@}*/
 
+/**
+ * @defgroup MDI_ThreadedCode Threaded code object
+ *
+ * An abstract object for executing translated Operations.
+ */
+/**@{*/
+/**
+ * @brief ThreadedCode object abstraction
+ *
+ * A ThreadedCode is a translation of a range of decoded Operations
+ * for a given Execution context, such that the Execution can run
+ * them without per Operation client calls.
+ */
+typedef MDI_object_t MDI_ThreadedCode_t;
+/**@}*/
+
 /**
  * @addtogroup MDI_Operation
  */
@@ -158,6 +225,71 @@ typedef MDI_object_t MDI_Execution_t;
  */
 MDI_INTERFACE MDI_res_t MDI_Operation_init(MDI_Operation_t *self_ref, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params);
 
+/**
+ * @brief Operation storage size
+ *
+ * Get the storage size in bytes necessary for constructing an
+ * Operation with the given number of operands in a client
+ * provided storage with MDI_Operation_init_storage().
+ * The storage size includes the operands and an inline DecodeInfo.
+ *
+ * @param opcount The Operation number of operands.
+ * @return The storage size in bytes.
+ */
+MDI_INTERFACE MDI_size_t MDI_Operation_storage_size(MDI_size_t opcount);
+
+/**
+ * @brief Operation storage alignment
+ *
+ * Get the alignment in bytes required for a client provided
+ * Operation storage.
+ * Note that storages returned by malloc() are always suitably aligned.
+ *
+ * @return The storage alignment in bytes.
+ */
+MDI_INTERFACE MDI_size_t MDI_Operation_storage_align(void);
+
+/**
+ * @brief Create a new Operation into a client storage
+ *
+ * Same as MDI_Operation_init(), though the Operation, its operands
+ * and its inline DecodeInfo are constructed into the given storage,
+ * without any allocation.
+ * The storage must be at least MDI_Operation_storage_size() bytes,
+ * aligned on MDI_Operation_storage_align() and must remain valid
+ * until the Operation is destroyed with MDI_Operation_fini(), which
+ * does not release the storage.
+ *
+ * @param self_ref A reference to the Operation object to construct.
+ * @param storage The storage for the Operation.
+ * @param storage_size The storage size in bytes.
+ * @param operator The Operation MDI Operator.
+ * @param opcount The Operation number of operands.
+ * @param operands The pointer to the Abstract Operands buffer.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_init_storage(MDI_Operation_t *self_ref, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params);
+
+/**
+ * @brief Create a new Operation from an OperationPool
+ *
+ * Same as MDI_Operation_init(), though the Operation storage is
+ * allocated from the given pool.
+ * Calling MDI_Operation_fini() on such an Operation is valid but does
+ * not release its storage, which is released when the pool is reset
+ * or destroyed.
+ *
+ * @param self_ref A reference to the Operation object to construct.
+ * @param pool The OperationPool to allocate from.
+ * @param operator The Operation MDI Operator.
+ * @param opcount The Operation number of operands.
+ * @param operands The pointer to the Abstract Operands buffer.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_init_pool(MDI_Operation_t *self_ref, MDI_OperationPool_t pool, MDI_Operator_t operator, MDI_size_t opcount, MDI_ptr_t operands, MDI_object_t params);
+
 /**
  * @brief Destroy an Operation instance
  *
@@ -217,6 +349,24 @@ MDI_INTERFACE MDI_DecodeInfo_t MDI_Operation_decode_info(MDI_Operation_t self);
  * @param decode_info The DecodeInfo object.
  */
 MDI_INTERFACE void MDI_Operation_set_decode_info(MDI_Operation_t self, MDI_DecodeInfo_t decode_info);
+
+/**
+ * @brief Initialize inline decode information
+ *
+ * Initialize the DecodeInfo object held inline by the Operation
+ * and set it as the Operation DecodeInfo object, without any
+ * allocation.
+ * The inline DecodeInfo lives as long as the Operation, calling
+ * MDI_DecodeInfo_fini() on it is valid and has no effect.
+ *
+ * @param self The Operation.
+ * @param buffer The decode buffer address.
+ * @param offset The offset in the decode buffer.
+ * @param size The size of the encoded Operation at the decoded offset.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Operation_init_decode_info(MDI_Operation_t self, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size, MDI_object_t params);
 /**@}*/
 
 /**
@@ -282,6 +432,62 @@ MDI_INTERFACE MDI_size_t MDI_DecodeInfo_offset(MDI_DecodeInfo_t self);
 MDI_INTERFACE MDI_size_t MDI_DecodeInfo_size(MDI_DecodeInfo_t self);
 /**@}*/
 
+/**
+ * @addtogroup MDI_OperationPool
+ */
+/**@{*/
+
+/**
+ * @brief Create a new OperationPool
+ *
+ * Create a new empty pool. Storage is reserved by chunks of
+ * chunk_size bytes, larger chunks are reserved for larger
+ * allocations.
+ *
+ * @param self_ref A reference to the OperationPool object to construct.
+ * @param chunk_size The chunk size in bytes, or 0 for a default size.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_OperationPool_init(MDI_OperationPool_t *self_ref, MDI_size_t chunk_size, MDI_object_t params);
+
+/**
+ * @brief Destroy an OperationPool
+ *
+ * Release all the pool storage, including all the Operations
+ * allocated from it, which must not be used anymore.
+ *
+ * @param self_ref A reference to a valid OperationPool object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_OperationPool_fini(MDI_OperationPool_t *self_ref);
+
+/**
+ * @brief Reset an OperationPool
+ *
+ * Drop at once all the Operations allocated from the pool, which
+ * must not be used anymore. The pool storage is kept for
+ * subsequent allocations.
+ *
+ * @param self An OperationPool.
+ */
+MDI_INTERFACE void MDI_OperationPool_reset(MDI_OperationPool_t self);
+
+/**
+ * @brief Allocate from an OperationPool
+ *
+ * Allocate size bytes aligned on align bytes from the pool.
+ * This is a bump allocation which can be used for instance to get
+ * storages for MDI_Operation_init_storage().
+ *
+ * @param self An OperationPool.
+ * @param size The size in bytes.
+ * @param align The alignment in bytes, a power of 2.
+ * @return The allocated storage or NULL.
+ */
+MDI_INTERFACE MDI_ptr_mut_t MDI_OperationPool_alloc(MDI_OperationPool_t self, MDI_size_t size, MDI_size_t align);
+/**@}*/
+
 /**
  * @addtogroup MDI_Decoder
  */
@@ -311,6 +517,35 @@ MDI_INTERFACE MDI_res_t MDI_Decoder_init(MDI_Decoder_t *self_ref, MDI_interface_
  */
 MDI_INTERFACE MDI_res_t MDI_Decoder_fini(MDI_Decoder_t *self_ref);
 
+/**
+ * @brief Set the Decoder OperationPool
+ *
+ * Set the pool from which MDI_Decoder_decode() and
+ * MDI_Decoder_decode_batch() allocate new Operations.
+ * By default or when pool is @c NULL, Operations are allocated
+ * as for MDI_Operation_init().
+ *
+ * @param self A Decoder.
+ * @param pool The OperationPool or @c NULL.
+ */
+MDI_INTERFACE void MDI_Decoder_set_pool(MDI_Decoder_t self, MDI_OperationPool_t pool);
+
+/**
+ * @brief Set the Decoder origin
+ *
+ * Set the stream offset of the decoded buffers, added to the
+ * offsets recorded in the DecodeInfo of the decoded Operations.
+ * This allows a client decoding a stream by chunks to get Operation
+ * offsets relative to the start of the stream. The DecodeInfo buffer
+ * is moved back by the origin, i.e. it is the virtual stream start,
+ * such that buffer + offset is still the Operation address.
+ * The default origin is 0.
+ *
+ * @param self A Decoder.
+ * @param origin The stream offset of the decoded buffers start.
+ */
+MDI_INTERFACE void MDI_Decoder_set_origin(MDI_Decoder_t self, MDI_size_t origin);
+
 /**
  * @brief Decode a buffer into an Operation
  *
@@ -330,6 +565,337 @@ MDI_INTERFACE MDI_res_t MDI_Decoder_fini(MDI_Decoder_t *self_ref);
  * @return A new Operation instance or NULL on invalid Opcode..
  */
 MDI_INTERFACE MDI_Operation_t MDI_Decoder_decode(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr);
+
+/**
+ * @brief Decoded Operations storage size
+ *
+ * Get the storage size in bytes sufficient for any Operation
+ * decoded by this Decoder with MDI_Decoder_decode_storage().
+ *
+ * @param self A Decoder.
+ * @return The storage size in bytes.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_storage_size(MDI_Decoder_t self);
+
+/**
+ * @brief Decode a buffer into an Operation in a client storage
+ *
+ * Same as MDI_Decoder_decode(), though the Operation and its
+ * DecodeInfo are constructed into the given storage as for
+ * MDI_Operation_init_storage(), without any allocation.
+ * The storage must be at least MDI_Decoder_storage_size() bytes.
+ *
+ * @param self A Decoder.
+ * @param storage The storage for the Operation.
+ * @param storage_size The storage size in bytes.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param current_ptr The reference to the current decoding pointer.
+ * @return The Operation constructed in storage or NULL on invalid Opcode.
+ */
+MDI_INTERFACE MDI_Operation_t MDI_Decoder_decode_storage(MDI_Decoder_t self, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr);
+
+/**
+ * @name Decoder batch stop reasons
+ *
+ * Reasons for MDI_Decoder_decode_batch() to return.
+ * @{
+ */
+#define MDI_DECODE_STOP_COUNT 1    /**< The Operations array is full. */
+#define MDI_DECODE_STOP_END 2      /**< The end of the buffer was reached. */
+#define MDI_DECODE_STOP_PARTIAL 3  /**< The buffer ends before the end of an encoded Operation. */
+#define MDI_DECODE_STOP_INVALID 4  /**< An invalid Opcode was found. */
+#define MDI_DECODE_STOP_ERROR 5    /**< An Operation could not be constructed. */
+/**@}*/
+
+/**
+ * @brief Decode a buffer into an array of Operations
+ *
+ * Given the buffer and buffer_size to an encoded stream, decode
+ * successive Operations from current_ptr into the caller provided
+ * operations array, up to max_count Operations.
+ *
+ * This is equivalent to successive calls to MDI_Decoder_decode(),
+ * though the current_ptr reference may point to the buffer limit
+ * (buffer + buffer_size) and on return current_ptr is updated to the
+ * decoding point following the last decoded Operation.
+ * Hence the number of consumed bytes is the difference between the
+ * returned and the initial current_ptr values.
+ *
+ * The reason for stopping is returned in stop_ref as one of the
+ * MDI_DECODE_STOP_* values. In particular MDI_DECODE_STOP_PARTIAL
+ * allows a client decoding a stream by chunks to continue decoding
+ * from current_ptr once more bytes are available.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param current_ptr The reference to the current decoding pointer.
+ * @param operations The array receiving new Operation instances.
+ * @param max_count The number of Operations available in the array.
+ * @param stop_ref A reference receiving the stop reason, may be @c NULL.
+ * @return The number of Operations decoded into the array.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_decode_batch(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr, MDI_Operation_t *operations, MDI_size_t max_count, MDI_res_t *stop_ref);
+
+/**
+ * @brief Split a buffer at Operation boundaries
+ *
+ * Split the encoded buffer into at most max_chunks ranges of about
+ * the same size, each starting at an Operation boundary, without
+ * decoding. Decoding each range independently, for instance on
+ * separate threads with one Decoder each, gives the same Operations
+ * as decoding the whole buffer.
+ *
+ * The bounds array receives the returned count plus one offsets,
+ * range i being [bounds[i], bounds[i+1]), with bounds[0] being 0 and
+ * bounds[count] being buffer_size.
+ * Less ranges may be returned for small buffers.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param max_chunks The maximum number of ranges, at least 1.
+ * @param bounds The array receiving max_chunks + 1 offsets at most.
+ * @return The number of ranges.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_split(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_size_t max_chunks, MDI_size_t *bounds);
+
+/**
+ * @brief Index the Operation starts of a buffer
+ *
+ * Scan the encoded buffer for the offsets at which successive
+ * decodes from the buffer start would start, without decoding.
+ * The index allows random access decode, splitting, or Program
+ * Counter to Operation lookups by binary search.
+ * The last offset may start a partial or invalid Operation, which
+ * is only detected when decoding.
+ *
+ * The number of Operation starts is returned, though only the
+ * first max_count offsets are stored, buffer_size offsets being
+ * always enough.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer, at most 4GB.
+ * @param offsets The array receiving the offsets, may be @c NULL if max_count is 0.
+ * @param max_count The size of the offsets array.
+ * @return The number of Operation starts in the buffer.
+ */
+MDI_INTERFACE MDI_size_t MDI_Decoder_index(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, uint32_t *offsets, MDI_size_t max_count);
+
+/**
+ * @brief Attach a predecoded file for a buffer
+ *
+ * A predecoded file holds the Operations decoded successively from
+ * the buffer start in an implementation defined flat layout which is
+ * mapped in memory. It is keyed by a hash of the buffer content and
+ * the MDI revision.
+ * If fname is a predecoded file for the buffer it is mapped,
+ * otherwise the buffer is decoded and fname is written first.
+ * While attached, decodes from the buffer at the predecoded
+ * Operation starts construct the Operations without parsing the
+ * encoding, other decodes are unchanged.
+ * The buffer content must not change while attached.
+ * A @c NULL buffer detaches the current predecoded file.
+ *
+ * @param self A Decoder.
+ * @param buffer An encoded buffer pointer or @c NULL.
+ * @param buffer_size The size of the encoded buffer, at most 4GB.
+ * @param fname The predecoded file name.
+ * @return 0 on success, failure otherwise in which case the Decoder parses all decodes.
+ */
+MDI_INTERFACE MDI_res_t MDI_Decoder_predecode(MDI_Decoder_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_str_t fname);
+/**@}*/
+
+/**
+ * @addtogroup MDI_DecodeCache
+ */
+/**@{*/
+
+/**
+ * @brief Create a new DecodeCache
+ *
+ * Create a new decode cache of the given number of entries for the
+ * given Decoder. The Decoder must remain valid until the cache
+ * is destroyed.
+ *
+ * @param self_ref A reference to the DecodeCache object to construct.
+ * @param decoder The Decoder used on cache misses.
+ * @param entries The number of cached Operations, or 0 for a default size.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_DecodeCache_init(MDI_DecodeCache_t *self_ref, MDI_Decoder_t decoder, MDI_size_t entries, MDI_object_t params);
+
+/**
+ * @brief Destroy a DecodeCache
+ *
+ * Destruct a valid DecodeCache object and all its cached Operations.
+ *
+ * @param self_ref A reference to a valid DecodeCache object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_DecodeCache_fini(MDI_DecodeCache_t *self_ref);
+
+/**
+ * @brief Decode a buffer into a cached Operation
+ *
+ * Same as MDI_Decoder_decode(), though the Operation is returned from
+ * the cache when the same buffer location was already decoded.
+ *
+ * The returned Operation is owned by the cache, the client must not
+ * destroy it. It remains valid until the next call to
+ * MDI_DecodeCache_decode(), MDI_DecodeCache_invalidate() or
+ * MDI_DecodeCache_fini() on this cache.
+ *
+ * @param self A DecodeCache.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer.
+ * @param current_ptr The reference to the current decoding pointer.
+ * @return The cached Operation instance or NULL on invalid Opcode.
+ */
+MDI_INTERFACE MDI_Operation_t MDI_DecodeCache_decode(MDI_DecodeCache_t self, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_ptr_t *current_ptr);
+
+/**
+ * @brief Invalidate a code range
+ *
+ * Drop all cached Operations for the given buffer whose encoding
+ * overlaps the [offset, offset + size) range.
+ * This must be called when the encoded buffer is modified.
+ *
+ * @param self A DecodeCache.
+ * @param buffer An encoded buffer pointer.
+ * @param offset The range start offset in the encoded buffer.
+ * @param size The range size.
+ */
+MDI_INTERFACE void MDI_DecodeCache_invalidate(MDI_DecodeCache_t self, MDI_ptr_t buffer, MDI_size_t offset, MDI_size_t size);
+/**@}*/
+
+/**
+ * @addtogroup MDI_Program
+ */
+/**@{*/
+
+/**
+ * @brief Create a new Program
+ *
+ * Decode successively the Operations of the buffer from its start
+ * with the given Decoder, until the end of the buffer or the first
+ * Operation that can't be decoded, see MDI_Program_stop().
+ * The Decoder is not referenced after construction.
+ *
+ * @param self_ref A reference to the Program object to construct.
+ * @param decoder The Decoder.
+ * @param buffer An encoded buffer pointer.
+ * @param buffer_size The size of the encoded buffer, at most 4GB.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Program_init(MDI_Program_t *self_ref, MDI_Decoder_t decoder, MDI_ptr_t buffer, MDI_size_t buffer_size, MDI_object_t params);
+
+/**
+ * @brief Destroy a Program
+ *
+ * Destruct a valid Program object.
+ *
+ * @param self_ref A reference to a valid Program object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Program_fini(MDI_Program_t *self_ref);
+
+/**
+ * @brief Number of Operations of a Program
+ *
+ * @param self A Program.
+ * @return The number of decoded Operations, the size of the Program arrays.
+ */
+MDI_INTERFACE MDI_size_t MDI_Program_count(MDI_Program_t self);
+
+/**
+ * @brief Decoded size of a Program
+ *
+ * @param self A Program.
+ * @return The number of buffer bytes decoded into Operations.
+ */
+MDI_INTERFACE MDI_size_t MDI_Program_size(MDI_Program_t self);
+
+/**
+ * @brief Decode stop reason of a Program
+ *
+ * @param self A Program.
+ * @return The MDI_DECODE_STOP_* reason, MDI_DECODE_STOP_END if the whole buffer was decoded.
+ */
+MDI_INTERFACE MDI_res_t MDI_Program_stop(MDI_Program_t self);
+
+/**
+ * @brief Operator indexes of a Program
+ *
+ * @param self A Program.
+ * @return The array of the Operations Operator indexes.
+ */
+MDI_INTERFACE const uint16_t *MDI_Program_operators(MDI_Program_t self);
+
+/**
+ * @brief Offsets of a Program
+ *
+ * @param self A Program.
+ * @return The array of the Operations offsets in the decoded buffer, increasing.
+ */
+MDI_INTERFACE const uint32_t *MDI_Program_offsets(MDI_Program_t self);
+
+/**
+ * @brief Sizes of a Program
+ *
+ * @param self A Program.
+ * @return The array of the Operations encoded sizes.
+ */
+MDI_INTERFACE const uint32_t *MDI_Program_sizes(MDI_Program_t self);
+
+/**
+ * @brief Operands starts of a Program
+ *
+ * The operands of the Operation idx are the operands slab values
+ * from index starts[idx] to starts[idx + 1] excluded.
+ *
+ * @param self A Program.
+ * @return The array of count + 1 Operations operands starts.
+ */
+MDI_INTERFACE const uint32_t *MDI_Program_operand_starts(MDI_Program_t self);
+
+/**
+ * @brief Operands slab of a Program
+ *
+ * @param self A Program.
+ * @return The array of all Operations operands, see MDI_Program_operand_starts().
+ */
+MDI_INTERFACE const intptr_t *MDI_Program_operands(MDI_Program_t self);
+
+/**
+ * @brief Find an Operation of a Program
+ *
+ * @param self A Program.
+ * @param offset A buffer offset.
+ * @return The index of the Operation starting at offset or -1.
+ */
+MDI_INTERFACE MDI_size_t MDI_Program_find(MDI_Program_t self, MDI_size_t offset);
+
+/**
+ * @brief Construct an Operation of a Program
+ *
+ * Construct the Operation idx in the given storage, as for
+ * MDI_Operation_init_storage(), with a DecodeInfo for the given
+ * buffer. The storage size for the Decoder is always enough,
+ * see MDI_Decoder_storage_size().
+ *
+ * @param self A Program.
+ * @param idx The Operation index.
+ * @param storage The Operation storage.
+ * @param storage_size The storage size.
+ * @param buffer The decoded buffer pointer for the DecodeInfo.
+ * @return The constructed Operation, or @c NULL on failure.
+ */
+MDI_INTERFACE MDI_Operation_t MDI_Program_operation(MDI_Program_t self, MDI_size_t idx, MDI_ptr_mut_t storage, MDI_size_t storage_size, MDI_ptr_t buffer);
 /**@}*/
 
 /**
@@ -372,7 +938,8 @@ MDI_INTERFACE MDI_res_t MDI_Disassembler_fini(MDI_Disassembler_t *self_ref);
  * returned size if greater or equal to the buffer limit (buffer + buffer_size).
  * In this case also the returned current_ptr will point to the buffer limit
  * (buffer + buffer_size). The emitted bytes are always '\0' terminated even
- * when truncated.
+ * when truncated. Nothing is emitted when current_ptr is already at the
+ * buffer limit.
  *
  * @param self the Disassembler
  * @param operation The operation to disassemble.
@@ -413,6 +980,23 @@ MDI_INTERFACE MDI_res_t MDI_Execution_init(MDI_Execution_t *self_ref, MDI_interf
  */
 MDI_INTERFACE MDI_res_t MDI_Execution_fini(MDI_Execution_t *self_ref);
 
+/**
+ * @brief Bind an Operation for execution
+ *
+ * Resolve once the execution handler and the size of the Operation
+ * for the Execution context and keep them in the Operation, such
+ * that following MDI_Execution_execute() of the Operation, for
+ * instance a loop body held in a DecodeCache, dispatch directly.
+ * MDI_Execution_execute() binds unbound Operations itself, the binding
+ * is kept until the Operation is destroyed or its DecodeInfo is set,
+ * and is implementation defined for other Execution contexts.
+ *
+ * @param self An Execution context.
+ * @param operation A decoded Operation.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_bind(MDI_Execution_t self, MDI_Operation_t operation);
+
 /**
  * @brief Execute an Operation
  *
@@ -424,6 +1008,78 @@ MDI_INTERFACE MDI_res_t MDI_Execution_fini(MDI_Execution_t *self_ref);
  */
 MDI_INTERFACE MDI_res_t MDI_Execution_execute(MDI_Execution_t self, MDI_Operation_t operation);
 
+/**
+ * @name Execution run stop reasons
+ *
+ * Reasons for an Execution run to return, failures are
+ * reported as negative values.
+ * @{
+ */
+#define MDI_EXECUTION_STOP_STEPS 1  /**< The steps budget is exhausted. */
+#define MDI_EXECUTION_STOP_PC 2     /**< The stop Program Counter was reached. */
+#define MDI_EXECUTION_STOP_LOOP 3   /**< An Operation branched to itself. */
+#define MDI_EXECUTION_STOP_EXIT 4   /**< The Program Counter left the executed code. */
+#define MDI_EXECUTION_FAULT_EXECUTE (-1)/**< An Operation execution failed. */
+#define MDI_EXECUTION_FAULT_DECODE (-2)/**< No valid Operation at the Program Counter. */
+/**@}*/
+
+/**
+ * @brief Run a ThreadedCode
+ *
+ * Execute the ThreadedCode Operations from the current Program
+ * Counter until one of the MDI_EXECUTION_STOP_* conditions occurs
+ * or an Operation execution fails.
+ * The conditions are checked after each executed Operation, in the
+ * order: failure, branch to itself, stop Program Counter, steps
+ * budget and exit of the translated code.
+ *
+ * @param self An Execution context.
+ * @param code A ThreadedCode translated for this Execution.
+ * @param max_steps The maximum number of Operations to execute or 0 for no limit.
+ * @param stop_pc The Program Counter to stop at or -1 for none.
+ * @param steps_ref A reference receiving the number of executed Operations, may be @c NULL.
+ * @return The stop reason, <0 on failure.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_run_threaded(MDI_Execution_t self, MDI_ThreadedCode_t code, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref);
+
+/**
+ * @brief Run from a code buffer
+ *
+ * Fetch, decode and execute the Operations of the code buffer from
+ * the current Program Counter, taken as an offset in the buffer,
+ * until one of the MDI_EXECUTION_STOP_* conditions occurs or a
+ * fault. The conditions are checked after each executed Operation
+ * as for MDI_Execution_run_threaded(), except that
+ * MDI_EXECUTION_STOP_EXIT is never returned.
+ * Decoded Operations are kept by the Execution context for the
+ * following runs over the same buffer, hence the buffer content
+ * must not change between runs.
+ * On MDI_EXECUTION_FAULT_DECODE the Program Counter is left at the
+ * undecodable location.
+ *
+ * @param self An Execution context.
+ * @param buffer The code buffer.
+ * @param size The code buffer size.
+ * @param max_steps The maximum number of Operations to execute or 0 for no limit.
+ * @param stop_pc The Program Counter to stop at or -1 for none.
+ * @param steps_ref A reference receiving the number of executed Operations, may be @c NULL.
+ * @return The stop reason, a MDI_EXECUTION_FAULT_* (<0) on failure.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_run(MDI_Execution_t self, MDI_ptr_t buffer, MDI_size_t size, MDI_size_t max_steps, MDI_size_t stop_pc, MDI_size_t *steps_ref);
+
+/**
+ * @brief Set the predecoded file for runs
+ *
+ * Set the predecoded file used by MDI_Execution_run() when it
+ * decodes a new code buffer, see MDI_Decoder_predecode().
+ * The file name is copied.
+ *
+ * @param self An Execution context.
+ * @param fname The predecoded file name or @c NULL for none.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_Execution_set_predecode(MDI_Execution_t self, MDI_str_t fname);
+
 /**
  * @brief Execution context current Program Counter
  *
@@ -473,6 +1129,55 @@ MDI_INTERFACE void MDI_Execution_stepin(MDI_Execution_t self);
 MDI_INTERFACE void MDI_Execution_stepout(MDI_Execution_t self);
 /**@}*/
 
+/**
+ * @addtogroup MDI_ThreadedCode
+ */
+/**@{*/
+
+/**
+ * @brief Create a new ThreadedCode
+ *
+ * Translate an array of decoded Operations for the given Execution
+ * context. Operations must have a DecodeInfo, their decode offsets
+ * being their Program Counter values. The Operations are not
+ * referenced after translation and may be destroyed.
+ *
+ * @param self_ref A reference to the ThreadedCode object to construct.
+ * @param execution The Execution context the code is translated for.
+ * @param operations The array of Operations to translate.
+ * @param count The number of Operations.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_ThreadedCode_init(MDI_ThreadedCode_t *self_ref, MDI_Execution_t execution, const MDI_Operation_t *operations, MDI_size_t count, MDI_object_t params);
+
+/**
+ * @brief Create a new ThreadedCode from a Program
+ *
+ * Translate all the Operations of a Program for the given Execution
+ * context, as for MDI_ThreadedCode_init(), the Program offsets
+ * being the Program Counter values. The Program is not referenced
+ * after translation.
+ *
+ * @param self_ref A reference to the ThreadedCode object to construct.
+ * @param execution The Execution context the code is translated for.
+ * @param program The Program to translate.
+ * @param params Implementation defined parameters.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_ThreadedCode_init_program(MDI_ThreadedCode_t *self_ref, MDI_Execution_t execution, MDI_Program_t program, MDI_object_t params);
+
+/**
+ * @brief Destroy a ThreadedCode
+ *
+ * Destruct a valid ThreadedCode object.
+ *
+ * @param self_ref A reference to a valid ThreadedCode object.
+ * @return 0 on success, failure otherwise.
+ */
+MDI_INTERFACE MDI_res_t MDI_ThreadedCode_fini(MDI_ThreadedCode_t *self_ref);
+/**@}*/
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -32,6 +32,9 @@
 set -eou pipefail
 
 VERBOSE="${VERBOSE:-0}"
+PREDECODE="${PREDECODE:-}"
+INDEX="${INDEX:-}"
+JOBS="${JOBS:-1}"
 
 mdi_lib="${1?}"
 input="${2--}"
@@ -66,13 +69,13 @@ LDFLAGS="${LDFLAGS:-$CFLAGS}"
 mdi_decode_c="$TOOLS_SRCDIR/mdi-decode.c"
 
 [ "$VERBOSE" = 0 ] || echo "Compiling mdi-decode.c"
-[ "$VERBOSE" = 0 ] || echo "$CC $CFLAGS $MDI_CFLAGS -c -o mdi-decode.o \"$mdi_decode_c\""
-$CC $CFLAGS $MDI_CFLAGS -c -o "$tmpdir"/mdi-decode.o "$mdi_decode_c"
+[ "$VERBOSE" = 0 ] || echo "$CC $CFLAGS -pthread $MDI_CFLAGS -c -o mdi-decode.o \"$mdi_decode_c\""
+$CC $CFLAGS -pthread $MDI_CFLAGS -c -o "$tmpdir"/mdi-decode.o "$mdi_decode_c"
 
 [ "$VERBOSE" = 0 ] || echo "Linking mdi-decode.o with given library: \"$mdi_lib\""
-[ "$VERBOSE" = 0 ] || echo "$CCLD $LDFLAGS $MDI_LDFLAGS mdi_decode.o -o mdi-decode  \"$mdi_lib\""
-$CCLD $LDFLAGS $MDI_LDFLAGS "$tmpdir"/mdi-decode.o -o "$tmpdir"/mdi-decode  "$mdi_lib"
+[ "$VERBOSE" = 0 ] || echo "$CCLD $LDFLAGS -pthread $MDI_LDFLAGS mdi_decode.o -o mdi-decode  \"$mdi_lib\""
+$CCLD $LDFLAGS -pthread $MDI_LDFLAGS "$tmpdir"/mdi-decode.o -o "$tmpdir"/mdi-decode  "$mdi_lib"
 
 [ "$VERBOSE" = 0 ] || echo "Decoding \"$input\" to \"$output\""
-[ "$VERBOSE" = 0 ] || echo "${EXEC-} mdi-decode \"$input\" \"$output\""
-${EXEC-} "$tmpdir"/mdi-decode "$input" "$output"
+[ "$VERBOSE" = 0 ] || echo "${EXEC-} mdi-decode ${INDEX:+-i }-j \"$JOBS\" ${PREDECODE:+-c \"$PREDECODE\" }\"$input\" \"$output\""
+${EXEC-} "$tmpdir"/mdi-decode ${INDEX:+-i} -j "$JOBS" ${PREDECODE:+-c "$PREDECODE"} "$input" "$output"
@@ -32,6 +32,7 @@
 set -eou pipefail
 
 VERBOSE="${VERBOSE:-0}"
+PREDECODE="${PREDECODE:-}"
 
 mdi_lib="${1?}"
 input="${2--}"
@@ -73,5 +74,5 @@ $CC $CFLAGS $MDI_CFLAGS -c -o "$tmpdir"/mdi-execute.o "$mdi_execute_c"
 $CCLD $LDFLAGS $MDI_LDFLAGS "$tmpdir"/mdi-execute.o -o "$tmpdir"/mdi-execute  "$mdi_lib"
 
 [ "$VERBOSE" = 0 ] || echo "Executing \"$input\""
-[ "$VERBOSE" = 0 ] || echo "${EXEC-} mdi-execute \"$input\""
-${EXEC-} "$tmpdir"/mdi-execute "$input"
+[ "$VERBOSE" = 0 ] || echo "${EXEC-} mdi-execute ${PREDECODE:+-c \"$PREDECODE\" }\"$input\""
+${EXEC-} "$tmpdir"/mdi-execute ${PREDECODE:+-c "$PREDECODE"} "$input"
@@ -33,22 +33,79 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <MDI/mdi.h>
 #include <MDI/mdi_operations.h>
 
 static int verbose = 1;
+static const char *predecode_fname = NULL;
+
+#define CHUNK_SIZE (1024 * 1024)
+
+/*
+ * Map a regular file input, read only, without copy.
+ * Returns 0 on success, otherwise the input must be read.
+ */
+int map_input(FILE *input, char **buffer_ref, size_t *size_ref)
+{
+    struct stat st;
+    void *map;
+
+    if (fstat(fileno(input), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+        return -1;
+    if ((uint64_t)st.st_size != (uint64_t)(size_t)st.st_size)
+        return -1;
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(input), 0);
+    if (map == MAP_FAILED)
+        return -1;
+    madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+    *buffer_ref = (char *)map;
+    *size_ref = (size_t)st.st_size;
+    return 0;
+}
+
+/*
+ * Read the whole input, as execution needs random access to the code.
+ */
+int read_input(FILE *input, char **buffer_ref, size_t *size_ref)
+{
+    char *buffer = NULL, *new_buffer;
+    size_t size = 0, alloc = 0, nread;
+
+    do {
+        if (size == alloc) {
+            alloc = alloc == 0 ? CHUNK_SIZE: alloc * 2;
+            new_buffer = (char *)realloc(buffer, alloc);
+            if (new_buffer == NULL) {
+                free(buffer);
+                return -1;
+            }
+            buffer = new_buffer;
+        }
+        nread = fread(buffer + size, 1, alloc - size, input);
+        size += nread;
+    } while (nread > 0);
+    if (ferror(input)) {
+        free(buffer);
+        return -1;
+    }
+    *buffer_ref = buffer;
+    *size_ref = size;
+    return 0;
+}
 
 int execute(MDI_interface_t interface, const char *input_fname)
 {
-    static char buffer[4096];
+    char *buffer = NULL;
     int rcode = -1;
     FILE *input;
     size_t nbytes;
+    int mapped = 0;
     MDI_Execution_t execution = NULL;
-    MDI_Decoder_t decoder = NULL;
-    MDI_Disassembler_t disassembler = NULL;
     MDI_res_t res;
-    MDI_size_t stop_pc, next_pc;
+    MDI_size_t stop_pc, next_pc, steps;
     uint64_t count = 0;
 
     if (strcmp(input_fname, "-") == 0) {
@@ -62,95 +119,56 @@ int execute(MDI_interface_t interface, const char *input_fname)
         }
     }
 
-    nbytes = fread(buffer, 1, sizeof(buffer), input);
-    if (nbytes < sizeof(buffer) && !feof(input)) {
+    mapped = map_input(input, &buffer, &nbytes) == 0;
+    if (!mapped && read_input(input, &buffer, &nbytes) != 0) {
         fprintf(stderr, "error while reading %s: ", input_fname);
         perror("");
         goto end_of_execute;
     }
 
-    res = MDI_Decoder_init(&decoder, interface, (MDI_Processor_t)0, NULL);
+    res = MDI_Execution_init(&execution, interface, (MDI_Processor_t)0, NULL);
     if (res != 0) {
-        fprintf(stderr, "error creating Decoder\n");
+        fprintf(stderr, "error creating Execution\n");
         goto end_of_execute;
     }
 
-    if (verbose >= 2) {
-        res = MDI_Disassembler_init(&disassembler, interface, (MDI_Processor_t)0, NULL);
+    if (predecode_fname != NULL) {
+        res = MDI_Execution_set_predecode(execution, predecode_fname);
         if (res != 0) {
-            fprintf(stderr, "error creating Disassembler\n");
+            fprintf(stderr, "error setting predecoded file\n");
             goto end_of_execute;
         }
     }
-            
-    res = MDI_Execution_init(&execution, interface, (MDI_Processor_t)0, NULL);
-    if (res != 0) {
-        fprintf(stderr, "error creating Execution\n");
-        goto end_of_execute;
-    }
 
     next_pc = MDI_Execution_pc(execution);
     stop_pc = next_pc; /* Assume processor stopped if PC at reset is reach again. */
     fprintf(stdout, "Start of execution at PC: %"PRIuPTR"\n", next_pc);
-    while (1) {
-        char *current_ptr;
-        MDI_res_t res;
-        MDI_Operation_t operation;
-        MDI_size_t pc;
-
-        pc = next_pc;
-        current_ptr = buffer + pc;
-        if (verbose >= 2) {
-            fprintf(stderr, "%.16s[...]\n", current_ptr);
-        }
-        operation = MDI_Decoder_decode(decoder, buffer, nbytes, (MDI_ptr_t *)&current_ptr);
-        if (operation == NULL) {
-            fprintf(stderr, "%s: invalid operation decode at PC: %"PRIuPTR"\n", input_fname, pc);
-            goto end_of_execute;
-        }
-        if (verbose >= 2) {
-            fprintf(stdout, "decoded operation at PC: %"PRIuPTR", next operation PC: %"PRIuPTR"\n",
-                    pc, current_ptr - buffer);
-        }
-        if (verbose >= 2) {
-            static char print_buffer[32];
-            MDI_ptr_mut_t current = print_buffer;
-            MDI_Disassembler_disassemble(disassembler, operation, print_buffer, sizeof(print_buffer), &current);
-            fprintf(stdout, "  op: %s\n", print_buffer);
-        }
-
-        res = MDI_Execution_execute(execution, operation);
-        if (res != 0) {
-            fprintf(stderr, "%s: invalid operation execution at PC: %"PRIuPTR"\n", input_fname, pc);
-            goto end_of_execute;
-        }
-        if (MDI_Operation_decode_info(operation)) {
-            MDI_DecodeInfo_t decode_info = MDI_Operation_decode_info(operation);
-            MDI_DecodeInfo_fini(&decode_info);
-        }
-        MDI_Operation_fini(&operation);
 
-        count += 1;
-        next_pc = MDI_Execution_pc(execution);
-        if (verbose >= 2) {
-            fprintf(stdout, "executed operation at PC: %"PRIuPTR", next execution PC: %"PRIuPTR"\n",
-                    pc, next_pc);
-        }
-        if (next_pc == pc) {
-            if (verbose >= 1) {
-                fprintf(stdout, "processor PC busy loop, assuming stopped at PC: %"PRIuPTR"\n",
-                        next_pc);
-            }
-            break;
+    /* The code buffer is decoded and executed by the Execution context. */
+    res = MDI_Execution_run(execution, buffer, nbytes, 0, stop_pc, &steps);
+    count += steps;
+    next_pc = MDI_Execution_pc(execution);
+    if (res == MDI_EXECUTION_FAULT_DECODE) {
+        fprintf(stderr, "%s: invalid operation decode at PC: %"PRIuPTR"\n", input_fname, next_pc);
+        goto end_of_execute;
+    }
+    if (res < 0) {
+        fprintf(stderr, "%s: invalid operation execution at PC: %"PRIuPTR", after %"PRIu64" instructions\n",
+                input_fname, next_pc, count);
+        goto end_of_execute;
+    }
+    if (res == MDI_EXECUTION_STOP_LOOP) {
+        if (verbose >= 1) {
+            fprintf(stdout, "processor PC busy loop, assuming stopped at PC: %"PRIuPTR"\n",
+                    next_pc);
         }
-        if (next_pc == stop_pc) {
-            if (verbose >= 1) {
-                fprintf(stdout, "processor PC stop value, assuming reset at PC: %"PRIuPTR"\n",
-                        next_pc);
-            }
-            break;
+    } else if (res == MDI_EXECUTION_STOP_PC) {
+        if (verbose >= 1) {
+            fprintf(stdout, "processor PC stop value, assuming reset at PC: %"PRIuPTR"\n",
+                    next_pc);
         }
     }
+
     if (verbose >= 1) {
         fprintf(stdout, "End of execution at PC: %"PRIuPTR"\n", MDI_Execution_pc(execution));
         fprintf(stdout, "  Insrructions count: %"PRIu64"\n", count);
@@ -159,9 +177,9 @@ int execute(MDI_interface_t interface, const char *input_fname)
     }
     rcode = 0;
  end_of_execute:
-    if (decoder != NULL) MDI_Decoder_fini(&decoder);
-    if (disassembler != NULL) MDI_Disassembler_fini(&disassembler);
     if (execution != NULL) MDI_Execution_fini(&execution);
+    if (mapped) munmap(buffer, nbytes);
+    else free(buffer);
     if (input != NULL && input != stdin) fclose(input);
     return rcode;
 }
@@ -172,6 +190,11 @@ int main(int argc, char *argv[])
     int rcode;
     MDI_interface_t interface;
 
+    if (argc >= 3 && strcmp(argv[1], "-c") == 0) {
+        predecode_fname = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
     if (argc < 2) {
         fprintf(stderr, "missign argument\n");
         exit(1);
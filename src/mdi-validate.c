@@ -30,7 +30,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <MDI/mdi.h>
+#include <MDI/mdi_operations.h>
 
 
 static int failed = 0;
@@ -140,6 +142,71 @@ static void validate_operators(MDI_interface_t interface)
     CHECKPOINT("Operators attributes validity");
 }
 
+/*
+ * Disassembles each Operator into buffers of the exact size, one byte
+ * short and already full, checking that truncated outputs are nul
+ * terminated and never written past the buffer limit.
+ */
+static void validate_disassembler(MDI_interface_t interface)
+{
+    static const intptr_t operands[] = { 1, 2, 3, 4 };
+    char full[256], buffer[sizeof(full) + 1];
+    MDI_ptr_mut_t current;
+    MDI_Disassembler_t disassembler;
+    MDI_Operation_t operation;
+    MDI_size_t nbytes;
+    MDI_res_t res;
+    MDI_idx_t count;
+    int i;
+
+    res = MDI_Disassembler_init(&disassembler, interface, (MDI_Processor_t)0, NULL);
+    TEST(res == 0, "Disassembler creation");
+
+    count = MDI_Operators_count(interface);
+
+    for (i = 0; i < count; i++) {
+        res = MDI_Operation_init(&operation, MDI_Operators_iter(interface, i),
+                                 sizeof(operands) / sizeof(operands[0]), (MDI_ptr_t)operands, NULL);
+        CHECK(res == 0, "Operation creation");
+        if (res != 0) continue;
+
+        current = full;
+        nbytes = MDI_Disassembler_disassemble(disassembler, operation, full, sizeof(full), &current);
+        CHECK(nbytes > 0 && (size_t)nbytes < sizeof(full), "Disassembly size in range");
+        if (nbytes <= 0 || (size_t)nbytes >= sizeof(full)) {
+            MDI_Operation_fini(&operation);
+            continue;
+        }
+        CHECK(current == full + nbytes && strlen(full) == (size_t)nbytes, "Disassembly size exact");
+
+        memset(buffer, '#', sizeof(buffer));
+        current = buffer;
+        CHECK(MDI_Disassembler_disassemble(disassembler, operation, buffer, nbytes + 1, &current) == nbytes,
+              "Disassembly size in an exact size buffer");
+        CHECK(current == buffer + nbytes && strcmp(buffer, full) == 0 && buffer[nbytes + 1] == '#',
+              "Disassembly into an exact size buffer");
+
+        memset(buffer, '#', sizeof(buffer));
+        current = buffer;
+        CHECK(MDI_Disassembler_disassemble(disassembler, operation, buffer, nbytes, &current) == nbytes,
+              "Disassembly size in a one byte short buffer");
+        CHECK(current == buffer + nbytes && buffer[nbytes - 1] == '\0' && buffer[nbytes] == '#' &&
+              strncmp(buffer, full, nbytes - 1) == 0,
+              "Disassembly truncated into a one byte short buffer");
+
+        CHECK(MDI_Disassembler_disassemble(disassembler, operation, buffer, nbytes, &current) > 0,
+              "Disassembly size in a full buffer");
+        CHECK(current == buffer + nbytes && buffer[nbytes - 1] == '\0' && buffer[nbytes] == '#',
+              "Disassembly into a full buffer");
+
+        MDI_Operation_fini(&operation);
+    }
+
+    res = MDI_Disassembler_fini(&disassembler);
+    CHECK(res == 0, "Disassembler destruction");
+    CHECKPOINT("Disassembler truncation");
+}
+
 static void validate_interface(void)
 {
     MDI_rev_t rev;
@@ -162,6 +229,8 @@ static void validate_interface(void)
 
     validate_operators(interface);
 
+    validate_disassembler(interface);
+
     res = MDI_interface_fini(&interface);
     TEST(res == 0, "Interface destruction");
 }